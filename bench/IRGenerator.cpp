@@ -0,0 +1,186 @@
+/**
+ *  IRGenerator.cpp
+ *
+ *  Generates synthetic LLVM IR of a controlled shape to benchmark the
+ *  interval analysis: sequential diamonds, loop nests, many live variables
+ *  and long straight-line blocks.
+ */
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../include/Support/StringUtils.h"
+
+#define DIAMONDS_OPTION "--diamonds="
+#define LOOP_DEPTH_OPTION "--loop-depth="
+#define VARIABLES_OPTION "--variables="
+#define STRAIGHT_LINE_OPTION "--straight-line="
+#define LOOP_TRIP_COUNT 10
+
+using namespace llvm;
+
+typedef struct {
+    unsigned diamonds;
+    unsigned loopDepth;
+    unsigned variables;
+    unsigned straightLine;
+} ir_shape_t;
+
+bool parseShapeOption (const char*, ir_shape_t*);
+void emitStraightLine (IRBuilder<>*, const std::vector<AllocaInst*>&, unsigned);
+void emitDiamonds (IRBuilder<>*, Function*, AllocaInst*, const std::vector<AllocaInst*>&, unsigned);
+void emitLoopNest (IRBuilder<>*, Function*, const std::vector<AllocaInst*>&, unsigned, unsigned);
+Value* loadVariable (IRBuilder<>*, AllocaInst*);
+
+int main (int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <output file> [%s<n>] [%s<d>] [%s<v>] [%s<l>]\n", argv[0], DIAMONDS_OPTION, LOOP_DEPTH_OPTION, VARIABLES_OPTION, STRAIGHT_LINE_OPTION);
+        return EXIT_FAILURE;
+    }
+    ir_shape_t shape = {0, 0, 1, 0};
+    for (int arg = 2; arg < argc; ++arg) {
+        if (!parseShapeOption(argv[arg], &shape)) {
+            fprintf(stderr, "error: unknown option \"%s\"\n", argv[arg]);
+            return EXIT_FAILURE;
+        }
+    }
+    shape.variables = (shape.variables == 0) ? 1 : shape.variables;
+
+    LLVMContext Context;
+    Module M("synthetic", Context);
+    IRBuilder<> builder(Context);
+    Function* F = Function::Create(FunctionType::get(builder.getInt32Ty(), false), Function::ExternalLinkage, "main", &M);
+    builder.SetInsertPoint(BasicBlock::Create(Context, "entry", F));
+
+    // Every variable starts out with a distinct known value, the input is never stored
+    AllocaInst* input = builder.CreateAlloca(builder.getInt32Ty(), nullptr, "input");
+    std::vector<AllocaInst*> variables;
+    for (unsigned var = 0; var < shape.variables; ++var) {
+        variables.push_back(builder.CreateAlloca(builder.getInt32Ty(), nullptr, "v" + std::to_string(var)));
+    }
+    for (unsigned var = 0; var < shape.variables; ++var) {
+        builder.CreateStore(builder.getInt32(var), variables[var]);
+    }
+
+    emitStraightLine(&builder, variables, shape.straightLine);
+    emitDiamonds(&builder, F, input, variables, shape.diamonds);
+    emitLoopNest(&builder, F, variables, shape.loopDepth, 0);
+    builder.CreateRet(builder.getInt32(0));
+
+    if (verifyFunction(*F, &errs())) {
+        fprintf(stderr, "error: generated function is malformed\n");
+        return EXIT_FAILURE;
+    }
+    std::string text;
+    raw_string_ostream output(text);
+    M.print(output, nullptr);
+    output.flush();
+    FILE* file = fopen(argv[1], "w");
+    if ((file == nullptr) ||
+        (fwrite(text.data(), 1, text.size(), file) != text.size()) ||
+        (fclose(file) != 0)) {
+        fprintf(stderr, "error: failed to write \"%s\"\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
+
+bool parseShapeOption (const char* option, ir_shape_t* shape) {
+    const char* names[] = {DIAMONDS_OPTION, LOOP_DEPTH_OPTION, VARIABLES_OPTION, STRAIGHT_LINE_OPTION};
+    unsigned* fields[] = {&shape->diamonds, &shape->loopDepth, &shape->variables, &shape->straightLine};
+    for (unsigned field = 0; field < 4; ++field) {
+        if (strncmp(option, names[field], strlen(names[field])) == 0) {
+            return StringUtils::parseCount(option + strlen(names[field]), fields[field]);
+        }
+    }
+    return false;
+}
+
+void emitStraightLine (IRBuilder<>* builder, const std::vector<AllocaInst*>& variables, unsigned length) {
+    // Each statement reads one variable and writes the next, cycling through add, sub and mul
+    for (unsigned statement = 0; statement < length; ++statement) {
+        Value* operand = loadVariable(builder, variables[statement % variables.size()]);
+        Value* result;
+        switch (statement % 3) {
+            case 0:
+                result = builder->CreateAdd(operand, builder->getInt32(statement % 7 + 1));
+                break;
+            case 1:
+                result = builder->CreateSub(operand, builder->getInt32(statement % 5 + 1));
+                break;
+            default:
+                result = builder->CreateMul(operand, builder->getInt32(2));
+                break;
+        }
+        builder->CreateStore(result, variables[(statement + 1) % variables.size()]);
+    }
+}
+
+void emitDiamonds (IRBuilder<>* builder, Function* F, AllocaInst* input, const std::vector<AllocaInst*>& variables, unsigned count) {
+    LLVMContext& Context = F->getContext();
+    for (unsigned diamond = 0; diamond < count; ++diamond) {
+        AllocaInst* variable = variables[diamond % variables.size()];
+        BasicBlock* thenBlock = BasicBlock::Create(Context, "if.then", F);
+        BasicBlock* elseBlock = BasicBlock::Create(Context, "if.else", F);
+        BasicBlock* endBlock = BasicBlock::Create(Context, "if.end", F);
+
+        // Branching on the unknown input keeps both arms feasible
+        Value* condition = builder->CreateICmpSLT(loadVariable(builder, input), builder->getInt32(diamond));
+        builder->CreateCondBr(condition, thenBlock, elseBlock);
+
+        builder->SetInsertPoint(thenBlock);
+        builder->CreateStore(builder->CreateAdd(loadVariable(builder, variable), builder->getInt32(1)), variable);
+        builder->CreateBr(endBlock);
+
+        builder->SetInsertPoint(elseBlock);
+        builder->CreateStore(builder->CreateSub(loadVariable(builder, variable), builder->getInt32(1)), variable);
+        builder->CreateBr(endBlock);
+
+        builder->SetInsertPoint(endBlock);
+    }
+}
+
+void emitLoopNest (IRBuilder<>* builder, Function* F, const std::vector<AllocaInst*>& variables, unsigned depth, unsigned level) {
+    if (level >= depth) {
+        return;
+    }
+    LLVMContext& Context = F->getContext();
+    BasicBlock* entryBlock = &F->getEntryBlock();
+
+    // Counters are allocated up front like clang does at -O0
+    IRBuilder<> allocaBuilder(entryBlock, entryBlock->begin());
+    AllocaInst* counter = allocaBuilder.CreateAlloca(builder->getInt32Ty(), nullptr, "i" + std::to_string(level));
+    builder->CreateStore(builder->getInt32(0), counter);
+
+    // Named like clang's blocks only so reports read the same; loops are found
+    // from the control flow graph
+    BasicBlock* condBlock = BasicBlock::Create(Context, "while.cond", F);
+    BasicBlock* bodyBlock = BasicBlock::Create(Context, "while.body", F);
+    BasicBlock* endBlock = BasicBlock::Create(Context, "while.end", F);
+    builder->CreateBr(condBlock);
+
+    builder->SetInsertPoint(condBlock);
+    Value* condition = builder->CreateICmpSLT(loadVariable(builder, counter), builder->getInt32(LOOP_TRIP_COUNT));
+    builder->CreateCondBr(condition, bodyBlock, endBlock);
+
+    builder->SetInsertPoint(bodyBlock);
+    AllocaInst* variable = variables[level % variables.size()];
+    builder->CreateStore(builder->CreateAdd(loadVariable(builder, variable), builder->getInt32(level + 1)), variable);
+    emitLoopNest(builder, F, variables, depth, level + 1);
+    builder->CreateStore(builder->CreateAdd(loadVariable(builder, counter), builder->getInt32(1)), counter);
+    builder->CreateBr(condBlock);
+
+    builder->SetInsertPoint(endBlock);
+}
+
+Value* loadVariable (IRBuilder<>* builder, AllocaInst* variable) {
+    return builder->CreateLoad(variable->getAllocatedType(), variable);
+}
\ No newline at end of file
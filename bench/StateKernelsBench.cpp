@@ -0,0 +1,157 @@
+/**
+ *  StateKernelsBench.cpp
+ *
+ *  Measures the state kernels of every level this CPU supports against the
+ *  scalar path, on rows of 16 to 100k intervals, after checking that each
+ *  level computes exactly what the scalar kernels compute.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "../include/Support/StateKernels.h"
+#include "../include/Tracker/Interval.h"
+
+#define VARIABLES_PER_MEASUREMENT 20000000
+#define CHECK_VARIABLES 1027
+
+typedef struct {
+    std::vector<int64_t> lower;
+    std::vector<int64_t> upper;
+    std::vector<int64_t> otherLower;
+    std::vector<int64_t> otherUpper;
+} rows_t;
+
+static const char* kernelNames[] = {"join", "meet", "widen", "narrow", "includes", "equals"};
+static const unsigned KERNEL_COUNT = sizeof(kernelNames) / sizeof(kernelNames[0]);
+static const std::vector<int64_t> thresholds = {-1000, -100, 0, 100, 1000};
+static volatile unsigned sink;
+
+bool runKernel(const StateKernels::kernels_t& kernels, unsigned kernel, rows_t* rows) {
+    size_t count = rows->lower.size();
+    int64_t* lower = rows->lower.data();
+    int64_t* upper = rows->upper.data();
+    const int64_t* otherLower = rows->otherLower.data();
+    const int64_t* otherUpper = rows->otherUpper.data();
+    switch (kernel) {
+        case 0:
+            return kernels.join(lower, upper, otherLower, otherUpper, count);
+        case 1:
+            return kernels.meet(lower, upper, otherLower, otherUpper, count);
+        case 2:
+            return kernels.widen(lower, upper, otherLower, otherUpper, count, thresholds.data(), thresholds.size());
+        case 3:
+            return kernels.narrow(lower, upper, otherLower, otherUpper, count);
+        case 4:
+            return kernels.includes(lower, upper, otherLower, otherUpper, count);
+        default:
+            return kernels.equals(lower, upper, otherLower, otherUpper, count);
+    }
+}
+
+// Random bounds drawn from a few values, so that equal, nested, disjoint and
+// infinite bounds all come up often
+rows_t makeMixedRows(size_t count, std::mt19937_64* random) {
+    const int64_t values[] = {Interval::MINUS_INFINITY, -1000, -7, 0, 3, 100, 5000, Interval::PLUS_INFINITY};
+    std::uniform_int_distribution<unsigned> pick(0, 6);
+    rows_t rows;
+    for (size_t i = 0; i < count; ++i) {
+        for (auto bounds : {&rows.lower, &rows.otherLower}) {
+            bounds->push_back(values[pick(*random)]);
+        }
+        for (auto bounds : {&rows.upper, &rows.otherUpper}) {
+            bounds->push_back(values[1 + pick(*random)]);
+        }
+    }
+    return rows;
+}
+
+// The other row lies within this one: joins, widens and inclusion checks
+// scan every interval without finding a change, as at a settled loop head
+rows_t makeSettledRows(size_t count, std::mt19937_64* random) {
+    std::uniform_int_distribution<int64_t> inner(-500, 500);
+    std::uniform_int_distribution<int64_t> outer(500, 1000);
+    rows_t rows;
+    for (size_t i = 0; i < count; ++i) {
+        rows.lower.push_back(-outer(*random));
+        rows.upper.push_back(outer(*random));
+        int64_t first = inner(*random), second = inner(*random);
+        rows.otherLower.push_back(std::min(first, second));
+        rows.otherUpper.push_back(std::max(first, second));
+    }
+    return rows;
+}
+
+bool checkLevel(const StateKernels::kernels_t& kernels, std::mt19937_64* random) {
+    const StateKernels::kernels_t& scalar = *StateKernels::get(StateKernels::SCALAR);
+    for (unsigned round = 0; round < 100; ++round) {
+        // Odd lengths and offsets leave tails for the scalar part of every kernel
+        rows_t rows = makeMixedRows(CHECK_VARIABLES - round % 5, random);
+        if (round % 2 == 0) {
+            rows.otherLower = rows.lower;
+            rows.otherUpper = rows.upper;
+        }
+        for (unsigned kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            rows_t expected = rows, actual = rows;
+            bool expectedResult = runKernel(scalar, kernel, &expected);
+            bool actualResult = runKernel(kernels, kernel, &actual);
+            if ((expectedResult != actualResult) || (expected.lower != actual.lower) || (expected.upper != actual.upper)) {
+                fprintf(stderr, "%s %s differs from the scalar kernel\n", kernels.name, kernelNames[kernel]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+double measure(const StateKernels::kernels_t& kernels, unsigned kernel, const rows_t& initialRows) {
+    rows_t rows = initialRows;
+    if (kernel == KERNEL_COUNT - 1) {
+        // Equality stops at the first difference, compare a row with itself
+        rows.otherLower = rows.lower;
+        rows.otherUpper = rows.upper;
+    }
+    size_t iterations = std::max<size_t>(1, VARIABLES_PER_MEASUREMENT / rows.lower.size());
+    unsigned changed = runKernel(kernels, kernel, &rows);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t iteration = 0; iteration < iterations; ++iteration) {
+        changed += runKernel(kernels, kernel, &rows);
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = changed;
+    return std::chrono::duration<double, std::nano>(end - start).count() / (iterations * rows.lower.size());
+}
+
+int main() {
+    std::mt19937_64 random(42);
+    std::vector<const StateKernels::kernels_t*> levels;
+    for (auto level : {StateKernels::SCALAR, StateKernels::SSE42, StateKernels::AVX2}) {
+        if (StateKernels::get(level) != nullptr) {
+            levels.push_back(StateKernels::get(level));
+        }
+    }
+    for (auto kernels : levels) {
+        if (!checkLevel(*kernels, &random)) {
+            return 1;
+        }
+    }
+
+    // One JSON record per kernel, level and row length
+    printf("{\"selected\": \"%s\", \"results\": [", StateKernels::get().name);
+    bool first = true;
+    for (size_t variables : {16, 64, 256, 1024, 4096, 16384, 100000}) {
+        rows_t rows = makeSettledRows(variables, &random);
+        for (unsigned kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            double scalarTime = measure(*levels[0], kernel, rows);
+            for (auto kernels : levels) {
+                double time = (kernels == levels[0]) ? scalarTime : measure(*kernels, kernel, rows);
+                printf("%s\n  {\"kernel\": \"%s\", \"level\": \"%s\", \"variables\": %zu, \"ns_per_variable\": %.3f, \"speedup\": %.2f}",
+                       first ? "" : ",", kernelNames[kernel], kernels->name, variables, time, scalarTime / time);
+                first = false;
+            }
+        }
+    }
+    printf("\n]}\n");
+    return 0;
+}
\ No newline at end of file
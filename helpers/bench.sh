@@ -0,0 +1,32 @@
+# Sweeps synthetic IR shapes through bin/IntervalPass and collects one JSON record per run.
+# usage: helpers/bench.sh [engine] [output file] (defaults: worklist, bench/results.json)
+ENGINE=${1:-worklist}
+OUTPUT=${2:-bench/results.json}
+TIMEOUT=${BENCH_TIMEOUT:-60}
+WORKDIR=$(mktemp -d)
+
+helpers/check_llvm.sh || exit 1
+clang++  -o bin/IRGenerator bench/IRGenerator.cpp lib/Support/StringUtils.cpp `llvm-config --cxxflags` `llvm-config --ldflags` `llvm-config --libs` -lpthread -lncurses -ldl -I/Applications/Xcode.app/Contents/Developer/Toolchains/XcodeDefault.xctoolchain/usr/include/c++/v1 || exit 1
+
+run_shape () {
+    bin/IRGenerator $WORKDIR/shape.ll "$@" || exit 1
+    # --name=value options become a {"name": value, ...} object
+    SHAPE=$(for OPTION in "$@"; do OPTION=${OPTION#--}; printf '"%s": %s, ' ${OPTION%%=*} ${OPTION#*=}; done)
+    SHAPE="{${SHAPE%, }}"
+    rm -f $WORKDIR/run.json
+    if timeout $TIMEOUT bin/IntervalPass $WORKDIR/shape.ll --all --engine=$ENGINE --bench-json=$WORKDIR/run.json > /dev/null 2>&1; then
+        RESULT=$(cat $WORKDIR/run.json)
+    else
+        RESULT="{\"engine\": \"$ENGINE\", \"timeout\": true}"
+    fi
+    [ -s $OUTPUT.tmp ] && echo "," >> $OUTPUT.tmp
+    echo "  {\"shape\": $SHAPE, \"result\": $RESULT}" >> $OUTPUT.tmp
+}
+
+: > $OUTPUT.tmp
+for N in 1 2 4 8 16 32 64 128; do run_shape --diamonds=$N --loop-depth=0 --variables=4 --straight-line=0; done
+for D in 1 2 3 4 5 6; do run_shape --diamonds=0 --loop-depth=$D --variables=4 --straight-line=0; done
+for V in 8 32 128 512 2048; do run_shape --diamonds=4 --loop-depth=1 --variables=$V --straight-line=$V; done
+for L in 100 1000 10000 100000; do run_shape --diamonds=0 --loop-depth=0 --variables=4 --straight-line=$L; done
+(echo "["; cat $OUTPUT.tmp; echo "]") > $OUTPUT
+rm -rf $OUTPUT.tmp $WORKDIR
\ No newline at end of file
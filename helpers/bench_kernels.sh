@@ -0,0 +1,6 @@
+# Builds the state kernel micro-benchmark and writes its throughput against the scalar kernels as JSON.
+# usage: helpers/bench_kernels.sh [output file] (default: bench/kernels.json)
+OUTPUT=${1:-bench/kernels.json}
+
+clang++ -O2 -std=c++14 -o bin/StateKernelsBench bench/StateKernelsBench.cpp lib/Support/StateKernels.cpp -I/Applications/Xcode.app/Contents/Developer/Toolchains/XcodeDefault.xctoolchain/usr/include/c++/v1 || exit 1
+bin/StateKernelsBench > $OUTPUT
\ No newline at end of file
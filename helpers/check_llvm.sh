@@ -0,0 +1,7 @@
+# Stops the build when llvm-config points at an LLVM older than the analyzer's minimum version.
+MINIMUM=12
+VERSION=$(llvm-config --version) || exit 1
+if [ "${VERSION%%.*}" -lt $MINIMUM ]; then
+    echo "error: LLVM $MINIMUM or later is required, llvm-config reports $VERSION" >&2
+    exit 1
+fi
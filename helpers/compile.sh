@@ -1 +1,2 @@
-clang++  -o bin/IntervalPass src/IntervalPass.cpp lib/Analyzer/IntervalAnalyzer.cpp lib/Tracker/IntervalTracker.cpp lib/Tracker/ValueTracker.cpp `llvm-config --cxxflags` `llvm-config --ldflags` `llvm-config --libs` -lpthread -lncurses -ldl -I/Applications/Xcode.app/Contents/Developer/Toolchains/XcodeDefault.xctoolchain/usr/include/c++/v1
+helpers/check_llvm.sh || exit 1
+clang++  -o bin/IntervalPass src/IntervalPass.cpp lib/Analyzer/AnalysisBudget.cpp lib/Analyzer/IntervalAnalyzer.cpp lib/Analyzer/ContextTrie.cpp lib/Analyzer/WorklistEngine.cpp lib/Analyzer/LoopStructure.cpp lib/Analyzer/FunctionHasher.cpp lib/Analyzer/ResultCache.cpp lib/Analyzer/MappedResultCache.cpp lib/Analyzer/FunctionSummaries.cpp lib/Analyzer/SparseEngine.cpp lib/Analyzer/SeparationTracker.cpp lib/Tracker/IntervalTracker.cpp lib/Tracker/SlotNumbering.cpp lib/Tracker/ValueTracker.cpp lib/Support/Arena.cpp lib/Support/WorkStealingPool.cpp lib/Support/Profiler.cpp lib/Support/Log.cpp lib/Support/ReportWriter.cpp lib/Support/StateKernels.cpp lib/Support/StringUtils.cpp `llvm-config --cxxflags` `llvm-config --ldflags` `llvm-config --libs` -lpthread -lncurses -ldl $CXXFLAGS -I/Applications/Xcode.app/Contents/Developer/Toolchains/XcodeDefault.xctoolchain/usr/include/c++/v1
@@ -0,0 +1,2 @@
+helpers/check_llvm.sh || exit 1
+clang++ -shared -fPIC -o bin/IntervalPlugin.so lib/Pass/IntervalPassPlugin.cpp lib/Pass/IntervalAnalysisPass.cpp lib/Analyzer/AnalysisBudget.cpp lib/Analyzer/IntervalAnalyzer.cpp lib/Analyzer/WorklistEngine.cpp lib/Analyzer/LoopStructure.cpp lib/Analyzer/SeparationTracker.cpp lib/Tracker/IntervalTracker.cpp lib/Tracker/SlotNumbering.cpp lib/Tracker/ValueTracker.cpp lib/Support/Arena.cpp lib/Support/Profiler.cpp lib/Support/Log.cpp lib/Support/StateKernels.cpp lib/Support/StringUtils.cpp `llvm-config --cxxflags` $CXXFLAGS -undefined dynamic_lookup -I/Applications/Xcode.app/Contents/Developer/Toolchains/XcodeDefault.xctoolchain/usr/include/c++/v1
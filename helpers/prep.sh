@@ -6,3 +6,9 @@ clang -emit-llvm -c -o resources/example2.bc resources/example2.c
 
 clang -emit-llvm -S -o resources/example3.ll resources/example3.c
 clang -emit-llvm -c -o resources/example3.bc resources/example3.c
+
+clang -emit-llvm -S -o resources/example4.ll resources/example4.c
+clang -emit-llvm -c -o resources/example4.bc resources/example4.c
+
+clang -emit-llvm -S -o resources/example5.ll resources/example5.c
+clang -emit-llvm -c -o resources/example5.bc resources/example5.c
@@ -0,0 +1,54 @@
+#ifndef ANABDG_H
+#define ANABDG_H
+
+#include <chrono>
+#include <cstddef>
+#include "../Support/Arena.h"
+
+// Limits on the work one function analysis may spend, zero meaning no limit.
+// Engines charge every context and block visit as they go, and the first
+// limit found exceeded is kept as the reason. Once exhausted a budget stays
+// exhausted, and the engine finishes in a cheaper mode that still gives a
+// sound over-approximation. Memory is the peak of the arena the states of
+// the analysis live in. A budget belongs to a single analysis.
+class AnalysisBudget {
+    public:
+        typedef struct {
+            unsigned maxContexts;
+            unsigned maxVisits;
+            size_t maxMemoryBytes;
+            double deadlineMilliseconds;
+        } limits_t;
+
+        enum Reason {
+            WITHIN_BUDGET,
+            CONTEXTS,
+            VISITS,
+            MEMORY,
+            DEADLINE
+        };
+
+        // Static methods
+        static limits_t getUnlimited();
+        static bool isUnlimited(const limits_t& limits);
+        static const char* getReasonName(Reason reason);
+
+        explicit AnalysisBudget(const limits_t& limits);
+        void trackArena(const Arena* arena);
+        bool chargeContext();
+        bool chargeVisit();
+        bool isExhausted() const;
+        Reason getReason() const;
+
+    private:
+        limits_t limits;
+        const Arena* arena;
+        std::chrono::steady_clock::time_point start;
+        unsigned contexts;
+        unsigned visits;
+        Reason reason;
+
+        bool checkLimits();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef CTXTRIE_H
+#define CTXTRIE_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/BasicBlock.h"
+
+using namespace llvm;
+
+// Calling contexts of the recursive engine, interned as the nodes of a trie.
+// The root stands for the function and every other node for the path of
+// blocks leading to it, so a context is an integer identifier whose depth is
+// stored with it. The "function/block/..." names are only built by getName()
+// when a report is printed or written.
+class ContextTrie {
+    public:
+        typedef unsigned context_id_t;
+
+        static const context_id_t ROOT = 0;
+
+        explicit ContextTrie(std::string functionName);
+        context_id_t getChild(context_id_t parent, const BasicBlock* BB);
+        unsigned getDepth(context_id_t context) const;
+        std::string getName(context_id_t context) const;
+
+    private:
+        typedef struct {
+            context_id_t parent;
+            const BasicBlock* block;
+            unsigned depth;
+        } node_t;
+
+        std::string functionName;
+        std::vector<node_t> nodes;
+        DenseMap<std::pair<context_id_t, const BasicBlock*>, context_id_t> children;
+};
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef FNHASH_H
+#define FNHASH_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include "llvm/IR/Attributes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Value.h"
+
+using namespace llvm;
+
+// Structural 64-bit FNV-1a hashes of function bodies, stable across runs and
+// processes. Two functions hash alike when they have the same name, blocks,
+// instructions, operands, value names and call attributes, which is all the
+// analysis reads.
+class FunctionHasher {
+    public:
+        static uint64_t hashBytes(const void* data, size_t size, uint64_t seed);
+        static uint64_t hashString(const std::string& text, uint64_t seed);
+        static uint64_t hashInteger(uint64_t value, uint64_t seed);
+        static uint64_t getSeed();
+
+        // Hash of the body alone
+        uint64_t getStructuralHash(const Function* F);
+        // Hash of the body and of every defined function it can reach through calls
+        uint64_t getDependencyHash(const Function* F);
+
+    private:
+        std::unordered_map<const Function*, uint64_t> structuralHashes;
+
+        uint64_t hashOperand(const Value* operand, const std::unordered_map<const Value*, uint64_t>& localNumbers, uint64_t seed);
+        static uint64_t hashAttributes(const AttributeList& attributes, unsigned argumentCount, uint64_t seed);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef FNSUMM_H
+#define FNSUMM_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "llvm/IR/Function.h"
+#include "../Tracker/CallSummaryProvider.h"
+#include "../Tracker/IntervalTracker.h"
+#include "AnalysisBudget.h"
+#include "WorklistEngine.h"
+
+using namespace llvm;
+
+// Interval of the return value of every function reachable through calls,
+// computed bottom-up over the strongly connected components of the call
+// graph. Components whose callees are done run in parallel; recursive ones
+// are iterated from "never returns" with widening until they are stable.
+//
+// The summary of a function assumes nothing about its arguments. A call with
+// known argument intervals re-analyzes the callee under them once and keeps
+// the result for every later call with the same intervals.
+//
+// Every summary and specialization is a separate analysis under its own
+// budget. One that runs out degrades like any analyzed function, and the
+// first limit each function exceeded is kept for the report.
+class FunctionSummaries : public CallSummaryProvider {
+    public:
+        typedef struct {
+            bool returns;
+            interval_t returnInterval;
+        } summary_t;
+        typedef std::pair<const Function*, AnalysisBudget::Reason> degradation_t;
+
+        FunctionSummaries(const WorklistEngine::widening_options_t& options, const AnalysisBudget::limits_t& limits);
+        bool collect(const std::vector<Function*>& roots, std::string* error);
+        void build(unsigned jobs);
+        bool contains(const Function* function) const;
+        size_t size() const;
+        unsigned getComponentCount() const;
+        unsigned getRecursiveComponentCount() const;
+        unsigned getSpecializationCount() const;
+        std::vector<degradation_t> getDegradations() const;
+        bool getReturnInterval(const Function* caller, const Function* callee, const std::vector<interval_t>& arguments, interval_t* result) const override;
+
+    private:
+        WorklistEngine::widening_options_t options;
+        AnalysisBudget::limits_t limits;
+        std::vector<Function*> functions;
+        std::unordered_map<const Function*, unsigned> functionIndices;
+        std::vector<std::vector<unsigned>> callees;
+        std::vector<bool> called;
+        std::vector<unsigned> functionComponents;
+        std::vector<std::vector<unsigned>> components;
+        std::vector<summary_t> summaries;
+
+        // Argument-specific results, shared by every thread that analyzes a caller
+        mutable std::mutex specializationsLock;
+        mutable std::map<std::pair<unsigned, std::string>, summary_t> specializations;
+        mutable std::vector<unsigned> specializationCounts;
+
+        // Functions whose summary or a specialization ran out of budget, in function order
+        mutable std::mutex degradationsLock;
+        mutable std::map<unsigned, AnalysisBudget::Reason> degradations;
+
+        void computeComponents();
+        void buildComponent(unsigned component);
+        bool isRecursive(unsigned component) const;
+        bool isNeeded(unsigned component) const;
+        summary_t analyzeFunction(unsigned index, const std::vector<interval_t>& arguments) const;
+        summary_t getSpecialization(unsigned index, const std::vector<interval_t>& arguments) const;
+};
+
+#endif
\ No newline at end of file
@@ -1,28 +1,49 @@
 #ifndef ITVAANA_H
 #define ITVAANA_H
 
+#include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 #include "llvm/IR/Instruction.h"
 #include "../Tracker/ValueTracker.h"
 #include "../Tracker/IntervalTracker.h"
+#include "../Tracker/SlotNumbering.h"
+#include "SeparationTracker.h"
+#include "../Support/Arena.h"
 
 using namespace llvm;
 
 class IntervalAnalyzer : public IntervalTracker {
-    private:
-        std::string variableName;
-        IntervalTracker::interval_t interval;
-
     public:
-        IntervalAnalyzer(std::string varName);
+        // One context-to-interval map per analyzed variable, in variable order
+        typedef std::vector<IntervalTracker::var_map_t> var_report_t;
+        typedef std::vector<IntervalTracker::interval_t> interval_list_t;
+
+        // Static methods
+        static std::vector<std::string> getNamedVariables(const SlotNumbering* slots);
+
+        IntervalAnalyzer(std::vector<std::string> varNames, const SlotNumbering* slots, Arena* arena);
         IntervalAnalyzer(const IntervalAnalyzer& intervalAnalyzer);
-        IntervalTracker::interval_t processNewInstruction(Instruction *i);
+        IntervalAnalyzer& operator=(const IntervalAnalyzer& intervalAnalyzer) = default;
+        void processNewInstruction(Instruction *i);
         void printIntervalReport();
         void printIntervalTracker();
-        std::string getVariableName() const;
-        IntervalTracker::interval_t getInterval() const;
-        IntervalTracker::interval_t getUpdatedInterval();
+        std::vector<std::string> getVariableNames() const;
+        interval_list_t getIntervals() const;
+        void addIntervalsToReport(std::string contextName, var_report_t* report) const;
+        bool joinAnalyzer(const IntervalAnalyzer& other);
+        bool widenAnalyzer(const IntervalAnalyzer& other, const std::vector<int64_t>& thresholds);
+        bool narrowAnalyzer(const IntervalAnalyzer& other);
+        bool includesAnalyzer(const IntervalAnalyzer& other) const;
+        void trackSeparations(std::shared_ptr<const SeparationTracker::packing_t> packing, SeparationTracker::zone_stats_t* stats);
+        void addSeparationsToReport(std::string contextName, const std::vector<SeparationTracker::slot_pair_t>& pairSlots, var_report_t* report) const;
+
+    private:
+        // Shared between every fork of the analyzer, which never edits them
+        std::shared_ptr<const std::vector<std::string>> variableNames;
+        std::shared_ptr<const std::vector<int>> variableSlots;
+        SeparationTracker separationTracker;
 };
 
-#endif
+#endif
\ No newline at end of file
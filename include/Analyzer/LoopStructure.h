@@ -0,0 +1,46 @@
+#ifndef LOOPST_H
+#define LOOPST_H
+
+#include <vector>
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Function.h"
+
+using namespace llvm;
+
+// Loop structure of a function, taken from the CFG instead of block names.
+// LoopInfo gives the natural loops the recursive engine walks: a loop begins
+// at its header and ends at the exits taken from its header or latches, so
+// that a break or an early return inside the body does not end it.
+//
+// getWeakTopologicalOrder() lays the blocks out in Bourdoncle's weak
+// topological order: every loop is a component that starts at its head and
+// lists its body right after it, nested loops included, and every edge
+// that goes backwards in the order ends at the head of a component holding
+// its source. Stabilizing components innermost first and widening only at
+// heads then reaches a fixpoint, irreducible loops included.
+class LoopStructure {
+    public:
+        // A component spans the elements [index of its head, componentEnd)
+        typedef struct {
+            BasicBlock* block;
+            bool head;
+            unsigned componentEnd;
+        } wto_element_t;
+
+        // Static methods
+        static std::vector<wto_element_t> getWeakTopologicalOrder(Function* function);
+
+        explicit LoopStructure(Function* function);
+        bool isLoopBegin(const BasicBlock* BB) const;
+        bool isLoopEnd(const BasicBlock* BB) const;
+
+    private:
+        DominatorTree dominatorTree;
+        LoopInfo loopInfo;
+        SmallPtrSet<const BasicBlock*, 8> loopEnds;
+};
+
+#endif
\ No newline at end of file
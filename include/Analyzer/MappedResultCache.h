@@ -0,0 +1,71 @@
+#ifndef MAPCCH_H
+#define MAPCCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "ResultCache.h"
+
+// Interval reports shared by every run that points at the same file, keyed
+// on module, function and analysis options hashes. Lookups binary search the
+// mapped index in place; only a hit's own record is decoded, into the same
+// entry the incremental file loads, since reports are built from those.
+// Writers merge into a fresh file under an advisory lock and rename it over
+// the old one, so readers keep a complete mapping of whichever version they
+// opened.
+//
+// Host byte order, the magic doubles as a byte order check:
+//   header: u32 magic "ITVM", u32 version, u64 entry count,
+//           u64 records offset, u64 file size
+//   index:  per entry, sorted by key: u64 module, function and options
+//           hashes, u64 record offset from the records start, u64 size
+//   record: f64 analysis ms, string function name, u32 variable count,
+//           per variable: string name, u32 context count,
+//           per context: i64 lower, i64 upper (extreme values are the
+//           infinities), string context name
+//   string: u32 length and its bytes
+class MappedResultCache {
+    public:
+        typedef struct {
+            uint64_t moduleHash;
+            uint64_t functionHash;
+            uint64_t optionsHash;
+        } cache_key_t;
+        typedef std::pair<cache_key_t, const ResultCache::entry_t*> update_t;
+
+        static bool publish(const char* path, const std::vector<update_t>& updates);
+
+        MappedResultCache();
+        ~MappedResultCache();
+        bool open(const char* path);
+        bool read(const cache_key_t& key, ResultCache::entry_t* entry) const;
+        size_t size() const;
+
+    private:
+        typedef struct {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t entryCount;
+            uint64_t recordsOffset;
+            uint64_t fileSize;
+        } header_t;
+
+        typedef struct {
+            cache_key_t key;
+            uint64_t recordOffset;
+            uint64_t recordSize;
+        } index_entry_t;
+
+        const char* mapping;
+        size_t mappingSize;
+        const header_t* header;
+        const index_entry_t* index;
+
+        MappedResultCache(const MappedResultCache&) = delete;
+        MappedResultCache& operator=(const MappedResultCache&) = delete;
+        void close();
+        const index_entry_t* find(const cache_key_t& key) const;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef RESCCH_H
+#define RESCCH_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "IntervalAnalyzer.h"
+
+// Interval reports of a previous run keyed on function hashes. The file is
+// only reused when it was written with the same analysis options.
+//
+// Text, one record per line, names run to the end of their line:
+//   ITVCACHE <version> <options hash>
+//   F <function hash> <analysis ms> <variable count> <function name>
+//   V <context count> <variable name>
+//   C <lower> <upper> <context name>
+// Hashes are hexadecimal, bounds decimal with the infinities written as the
+// extreme 64-bit values that stand for them.
+class ResultCache {
+    public:
+        typedef struct {
+            std::string functionName;
+            std::vector<std::string> variableNames;
+            IntervalAnalyzer::var_report_t report;
+            double analysisTime;
+        } entry_t;
+
+        ResultCache(uint64_t optionsHash);
+        bool load(const char* path);
+        bool save(const char* path) const;
+        const entry_t* lookup(uint64_t functionHash) const;
+        void store(uint64_t functionHash, const entry_t& entry);
+        size_t size() const;
+
+    private:
+        uint64_t optionsHash;
+        std::unordered_map<uint64_t, entry_t> entries;
+};
+
+#endif
\ No newline at end of file
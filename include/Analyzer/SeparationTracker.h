@@ -1,28 +1,95 @@
 #ifndef SEPTRK_H
 #define SEPTRK_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <tuple>
+#include <utility>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
 #include "llvm/IR/Instruction.h"
-#include "../Tracker/ValueTracker.h"
+#include "../Tracker/Interval.h"
+#include "../Tracker/IntervalTracker.h"
+#include "../Tracker/SlotNumbering.h"
 
 using namespace llvm;
 
+// Difference-bound matrices over the variables of a function: for every pair
+// of variables x, y of one cluster it keeps the smallest known c with
+// x - y <= c. Row and column 0 stand for the constant zero, so the single
+// variable bounds x <= c and -x <= c live in the same matrix. Variables are
+// packed into clusters of at most MAX_CLUSTER_VARIABLES around the requested
+// pairs, so an update costs at most the square of a small cluster whatever
+// the size of the function. Matrices are kept closed: every assignment adds
+// its constraints through an incremental O(n^2) closure instead of a full
+// Floyd-Warshall pass.
 class SeparationTracker {
     public:
-        typedef std::tuple<std::string, std::string> var_pair_t;
+        typedef std::pair<std::string, std::string> var_pair_t;
+        typedef std::pair<int, int> slot_pair_t;
+        typedef Interval::interval_t interval_t;
 
-        SeparationTracker(std::string varNameOne, std::string varNameTwo);
-        double processNewEntry(Instruction *i);
-        void printSeparationReport();
-        void printVariableTracker();
-        double calculateSeparation();
-        double getSeparation();
+        // Which variables share a matrix, fixed for one function
+        typedef struct {
+            const SlotNumbering* slots;
+            // Per slot: the cluster and the row in its matrix, NO_CLUSTER when untracked
+            std::vector<int> clusterOf;
+            std::vector<unsigned> rowOf;
+            std::vector<unsigned> clusterSizes;
+        } packing_t;
+
+        // Filled in by every state of one function analysis
+        typedef struct {
+            unsigned clusters;
+            unsigned largestCluster;
+            unsigned updates;
+            uint64_t closureCells;
+            uint64_t maxClosureCells;
+        } zone_stats_t;
+
+        static const int NO_CLUSTER = -1;
+
+        // Static methods
+        static std::shared_ptr<const packing_t> packVariables(Function* function, const SlotNumbering* slots, const std::vector<slot_pair_t>& pairs);
+        static interval_t getDistance(interval_t difference);
+
+        SeparationTracker();
+        SeparationTracker(std::shared_ptr<const packing_t> packing, zone_stats_t* stats);
+        SeparationTracker(const SeparationTracker& other);
+        SeparationTracker& operator=(const SeparationTracker& other);
+        bool isTracking() const;
+        void processNewEntry(Instruction* i, const IntervalTracker& intervals);
+        bool getDifference(int firstSlot, int secondSlot, interval_t* difference) const;
+        bool joinTracker(const SeparationTracker& other);
+        bool widenTracker(const SeparationTracker& other);
+        bool narrowTracker(const SeparationTracker& other);
+        bool includesTracker(const SeparationTracker& other) const;
+        void printSeparationTracker() const;
 
     private:
-        var_pair_t variableNames;
-        ValueTracker valueTracker;
-        double separation;
+        // A register known to hold a variable plus a constant
+        typedef struct {
+            int slot;
+            int64_t offset;
+        } form_t;
+        typedef std::vector<int64_t> matrix_t;
+
+        std::shared_ptr<const packing_t> packing;
+        zone_stats_t* stats;
+        std::vector<std::shared_ptr<matrix_t>> matrices;
+        // Registers of the block being analyzed, a copied state starts without them
+        DenseMap<const Value*, form_t> forms;
+
+        unsigned getRowCount(unsigned cluster) const;
+        matrix_t& getWritableMatrix(unsigned cluster);
+        void trackForm(Instruction* i);
+        void assignVariable(int slot, Value* value, const IntervalTracker& intervals);
+        void forgetVariable(int slot);
+        void shiftVariable(int slot, int64_t offset);
+        void addConstraint(unsigned cluster, unsigned first, unsigned second, int64_t bound);
+        void forgetForms(int slot);
+        void runFullClosure(unsigned cluster);
 };
 
-#endif
+#endif
\ No newline at end of file
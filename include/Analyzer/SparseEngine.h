@@ -0,0 +1,90 @@
+#ifndef SPRENG_H
+#define SPRENG_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "../Tracker/CallSummaryProvider.h"
+#include "../Tracker/IntervalTracker.h"
+#include "../Support/Arena.h"
+#include "AnalysisBudget.h"
+#include "IntervalAnalyzer.h"
+#include "WorklistEngine.h"
+
+using namespace llvm;
+
+// Propagates intervals along def-use chains instead of copying whole block
+// states around. The function is analyzed as a promoted SSA copy: every
+// variable becomes a chain of registers joined by phis, and an instruction is
+// only evaluated again when one of its operands or incoming edges changed.
+// Branches whose condition interval rules a successor out keep it from
+// becoming executable, and phis at loop heads widen like block states do.
+// Each evaluation counts as a visit against the budget, and past the budget
+// every phi widens on each update without thresholds.
+class SparseEngine {
+    public:
+        // The promoted copy of a function, with one probe per variable before
+        // every exit, whose operand is the value the variable holds there
+        typedef struct {
+            Function* function;
+            std::vector<BasicBlock*> exitBlocks;
+            std::vector<std::vector<CallInst*>> probes;
+            unsigned variableCount;
+            unsigned promotedVariables;
+        } ssa_function_t;
+
+        // Static methods
+        static ssa_function_t prepareFunction(Function* function, const std::vector<std::string>& variableNames);
+        static void releaseFunction(const ssa_function_t& ssa);
+
+        SparseEngine(const ssa_function_t& ssa, const WorklistEngine::widening_options_t& options, const CallSummaryProvider* summaries);
+        void setBudget(AnalysisBudget* budget);
+        IntervalAnalyzer::var_report_t run(std::string functionContextName);
+        unsigned getEvaluations() const;
+        unsigned getPrunedEdges() const;
+        bool isDegraded() const;
+
+    private:
+        typedef IntervalTracker::interval_t interval_t;
+
+        ssa_function_t ssa;
+        const CallSummaryProvider* summaries;
+        Arena arena;
+        IntervalTracker transfer;
+        std::vector<int64_t> thresholds;
+        unsigned narrowingPasses;
+        std::vector<BasicBlock*> blockOrder;
+        std::unordered_map<const BasicBlock*, unsigned> blockIndex;
+        std::vector<bool> loopHeads;
+        std::vector<Instruction*> instructionOrder;
+        DenseMap<const Instruction*, unsigned> instructionIndex;
+
+        // Fixpoint state, a value missing from the map has not been reached
+        DenseMap<const Value*, interval_t> values;
+        DenseMap<const PHINode*, unsigned> phiUpdates;
+        DenseSet<const PHINode*> widenedPhis;
+        DenseSet<const CallInst*> neverReturning;
+        std::set<std::pair<const BasicBlock*, const BasicBlock*>> executableEdges;
+        std::vector<bool> executableBlocks;
+        std::set<unsigned> worklist;
+        unsigned evaluations;
+        AnalysisBudget* budget;
+
+        void computeOrder();
+        void markEdgeExecutable(BasicBlock* from, BasicBlock* to);
+        void visitInstruction(Instruction* I);
+        void visitTerminator(Instruction* I);
+        bool runNarrowingPass();
+        bool evaluate(Instruction* I, interval_t* result, bool trackCalls);
+        bool getOperandInterval(Value* operand, interval_t* result) const;
+        bool isBlocked(const BasicBlock* BB) const;
+        void pushUsers(Instruction* I);
+};
+
+#endif
\ No newline at end of file
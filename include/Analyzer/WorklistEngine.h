@@ -0,0 +1,79 @@
+#ifndef WKLENG_H
+#define WKLENG_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "AnalysisBudget.h"
+#include "IntervalAnalyzer.h"
+#include "LoopStructure.h"
+#include "../Support/Arena.h"
+
+using namespace llvm;
+
+// Keeps one abstract state per basic block and iterates the blocks in weak
+// topological order: every loop component is stabilized, innermost first,
+// before the blocks after it run. Widening happens only at component heads,
+// followed by a bounded number of narrowing passes. Once a budget given with
+// setBudget() is exhausted, every join widens without thresholds and the
+// narrowing passes are skipped, which stabilizes the remaining components
+// after a few more visits.
+class WorklistEngine {
+    public:
+        typedef struct {
+            std::vector<int64_t> thresholds;
+            bool harvestThresholds;
+            unsigned narrowingPasses;
+        } widening_options_t;
+        typedef std::pair<BasicBlock*, unsigned> loop_iterations_t;
+
+        // Static methods
+        static widening_options_t getDefaultOptions();
+        static std::vector<int64_t> harvestThresholds(Function* function);
+
+        WorklistEngine(Function* function, const IntervalAnalyzer& initialState, const widening_options_t& options, Arena* arena);
+        void setBudget(AnalysisBudget* budget);
+        IntervalAnalyzer::var_report_t run(std::string functionContextName);
+        IntervalAnalyzer::var_report_t reportSeparations(std::string functionContextName, const std::vector<SeparationTracker::slot_pair_t>& pairSlots) const;
+        unsigned getBlockVisits() const;
+        unsigned getPrunedEdges() const;
+        bool isDegraded() const;
+        std::vector<loop_iterations_t> getLoopHeadIterations() const;
+        const std::vector<int64_t>& getThresholds() const;
+        const IntervalAnalyzer* getExitState(const BasicBlock* BB) const;
+
+    private:
+        Function* function;
+        Arena* arena;
+        IntervalAnalyzer initialState;
+        std::vector<int64_t> thresholds;
+        unsigned narrowingPasses;
+        std::vector<BasicBlock*> blockOrder;
+        std::unordered_map<BasicBlock*, unsigned> blockIndex;
+        std::vector<bool> loopHeads;
+        std::vector<unsigned> componentEnds;
+        std::vector<bool> pending;
+        std::vector<Arena::ptr_t<IntervalAnalyzer>> inStates;
+        std::vector<Arena::ptr_t<IntervalAnalyzer>> outStates;
+        std::vector<std::vector<BasicBlock*>> outEdges;
+        // Out state narrowed by the branch condition of each edge, null when the edge adds nothing
+        std::vector<std::vector<Arena::ptr_t<IntervalAnalyzer>>> edgeStates;
+        std::vector<unsigned> blockIterations;
+        unsigned blockVisits;
+        AnalysisBudget* budget;
+
+        void computeBlockOrder();
+        bool isExitBlock(unsigned index) const;
+        void stabilizeBlocks(unsigned begin, unsigned end);
+        void visitBlock(unsigned index);
+        void analyzeBlock(unsigned index);
+        bool runNarrowingPass();
+        void computeFeasibleEdges(unsigned index);
+        const IntervalAnalyzer& getEdgeState(unsigned index, unsigned edge) const;
+        bool propagateState(unsigned successorIndex, const IntervalAnalyzer& state);
+};
+
+#endif
\ No newline at end of file
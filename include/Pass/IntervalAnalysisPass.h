@@ -0,0 +1,66 @@
+#ifndef ITVPAS_H
+#define ITVPAS_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../Analyzer/IntervalAnalyzer.h"
+#include "../Analyzer/WorklistEngine.h"
+#include "../Support/Arena.h"
+#include "../Tracker/IntervalTracker.h"
+#include "../Tracker/SlotNumbering.h"
+
+using namespace llvm;
+
+// Worklist interval analysis of every named alloca of a function. The result
+// keeps the per-block states alive so that later passes can query the
+// interval of a variable at the end of any block.
+class IntervalAnalysisResult {
+    public:
+        IntervalAnalysisResult(Function& F, const WorklistEngine::widening_options_t& options);
+        const std::vector<std::string>& getVariableNames() const;
+        const IntervalAnalyzer::var_report_t& getReport() const;
+        bool getExitInterval(const BasicBlock* BB, const std::string& variable, IntervalTracker::interval_t* interval) const;
+        void print(raw_ostream& OS) const;
+
+    private:
+        // Declared in destruction order: the engine's states live in the arena
+        std::unique_ptr<Arena> arena;
+        std::unique_ptr<SlotNumbering> slots;
+        std::unique_ptr<WorklistEngine> engine;
+        std::vector<std::string> variableNames;
+        IntervalAnalyzer::var_report_t report;
+};
+
+// Cached by the FunctionAnalysisManager and invalidated unless a pass
+// preserves it explicitly, since any changed instruction can change it
+class IntervalAnalysis : public AnalysisInfoMixin<IntervalAnalysis> {
+    public:
+        typedef IntervalAnalysisResult Result;
+
+        IntervalAnalysis();
+        IntervalAnalysis(const WorklistEngine::widening_options_t& options);
+        Result run(Function& F, FunctionAnalysisManager& FAM);
+
+    private:
+        friend AnalysisInfoMixin<IntervalAnalysis>;
+        static AnalysisKey Key;
+
+        WorklistEngine::widening_options_t options;
+};
+
+class IntervalPrinterPass : public PassInfoMixin<IntervalPrinterPass> {
+    public:
+        explicit IntervalPrinterPass(raw_ostream& OS);
+        PreservedAnalyses run(Function& F, FunctionAnalysisManager& FAM);
+        // Also print functions marked optnone, which is everything clang emits at -O0
+        static bool isRequired() { return true; }
+
+    private:
+        raw_ostream& OS;
+};
+
+#endif
\ No newline at end of file
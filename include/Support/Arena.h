@@ -0,0 +1,132 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Bump allocator owning every object of one function analysis. Memory handed
+// back early is kept on per-size free lists for reuse, and everything still
+// alive is destroyed and released in one shot by release() or the destructor.
+// An arena is not thread-safe; each analysis owns its own.
+class Arena {
+    public:
+        static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        template <typename T>
+        struct Deleter {
+            Arena* arena;
+            void operator()(T* object) const {
+                if (arena) {
+                    arena->destroy(object);
+                }
+                else {
+                    delete object;
+                }
+            }
+        };
+        template <typename T>
+        using ptr_t = std::unique_ptr<T, Deleter<T>>;
+
+        Arena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+        ~Arena();
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(size_t size, size_t alignment);
+        void deallocate(void* memory, size_t size);
+        void release();
+        size_t getBytesReserved() const;
+        size_t getPeakBytesInUse() const;
+
+        // Builds an object that lives until the arena is released
+        template <typename T, typename... Args>
+        T* create(Args&&... args) {
+            T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if (!std::is_trivially_destructible<T>::value) {
+                liveObjects[object] = std::make_pair(&destroyObject<T>, sizeof(T));
+            }
+            return object;
+        }
+
+        // Builds an object whose memory goes back to the arena when the
+        // returned pointer lets go of it
+        template <typename T, typename... Args>
+        ptr_t<T> make(Args&&... args) {
+            return ptr_t<T>(create<T>(std::forward<Args>(args)...), Deleter<T>{this});
+        }
+
+        template <typename T>
+        void destroy(T* object) {
+            liveObjects.erase(object);
+            object->~T();
+            deallocate(object, sizeof(T));
+        }
+
+    private:
+        typedef void (*destructor_t)(void*);
+
+        size_t blockSize;
+        std::vector<char*> blocks;
+        char* cursor;
+        char* limit;
+        std::unordered_map<void*, std::pair<destructor_t, size_t>> liveObjects;
+        std::unordered_map<size_t, std::vector<void*>> freeLists;
+        size_t bytesReserved;
+        size_t bytesInUse;
+        size_t peakBytesInUse;
+
+        template <typename T>
+        static void destroyObject(void* object) {
+            static_cast<T*>(object)->~T();
+        }
+};
+
+// Standard allocator drawing from an arena, or from the heap without one
+template <typename T>
+class ArenaAllocator {
+    public:
+        typedef T value_type;
+
+        ArenaAllocator(Arena* arena) : arena(arena) {}
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.getArena()) {}
+
+        T* allocate(size_t n) {
+            if (!arena) {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* memory, size_t n) {
+            if (!arena) {
+                ::operator delete(memory);
+                return;
+            }
+            arena->deallocate(memory, n * sizeof(T));
+        }
+
+        Arena* getArena() const {
+            return arena;
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const {
+            return arena == other.getArena();
+        }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const {
+            return arena != other.getArena();
+        }
+
+    private:
+        Arena* arena;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef BNDQUE_H
+#define BNDQUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// Blocking FIFO with a fixed capacity. Producers wait while it is full, so a
+// fast stage can only run a few items ahead of a slow one. Once closed, pop
+// drains what is left and then fails.
+template <typename T>
+class BoundedQueue {
+    public:
+        BoundedQueue(size_t capacity) : capacity((capacity == 0) ? 1 : capacity), closed(false) {
+        }
+
+        bool push(T item) {
+            std::unique_lock<std::mutex> guard(lock);
+            notFull.wait(guard, [this] { return closed || (items.size() < capacity); });
+            if (closed) {
+                return false;
+            }
+            items.push_back(std::move(item));
+            guard.unlock();
+            notEmpty.notify_one();
+            return true;
+        }
+
+        bool pop(T* item) {
+            std::unique_lock<std::mutex> guard(lock);
+            notEmpty.wait(guard, [this] { return closed || !items.empty(); });
+            if (items.empty()) {
+                return false;
+            }
+            *item = std::move(items.front());
+            items.pop_front();
+            guard.unlock();
+            notFull.notify_one();
+            return true;
+        }
+
+        void close() {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                closed = true;
+            }
+            notEmpty.notify_all();
+            notFull.notify_all();
+        }
+
+    private:
+        const size_t capacity;
+        std::mutex lock;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::deque<T> items;
+        bool closed;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,34 @@
+#ifndef LOGLVL_H
+#define LOGLVL_H
+
+#include <atomic>
+
+#define LOG_ERROR 0
+#define LOG_WARN 1
+#define LOG_INFO 2
+#define LOG_DEBUG 3
+#define LOG_TRACE 4
+
+// Messages above this level are compiled out, e.g. -DINTERVAL_LOG_LEVEL=1
+// keeps only errors and warnings
+#ifndef INTERVAL_LOG_LEVEL
+#define INTERVAL_LOG_LEVEL LOG_TRACE
+#endif
+
+// Diagnostics go to stderr so that stdout only carries the report. The
+// runtime level defaults to warnings, which keeps I/O out of the analysis.
+class Log {
+    public:
+        static int getLevel();
+        static void setLevel(int level);
+        static bool parseLevel(const char* name, int* level);
+        static void write(int level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    private:
+        static std::atomic<int> level;
+};
+
+#define LOG_ENABLED(level) (((level) <= INTERVAL_LOG_LEVEL) && ((level) <= Log::getLevel()))
+#define LOG(level, ...) do { if (LOG_ENABLED(level)) { Log::write(level, __VA_ARGS__); } } while (0)
+
+#endif
\ No newline at end of file
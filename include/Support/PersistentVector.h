@@ -0,0 +1,206 @@
+#ifndef PSTVEC_H
+#define PSTVEC_H
+
+#include <cstddef>
+#include <memory>
+#include "Arena.h"
+
+// Storage of one trie leaf, by default the values side by side. Another
+// layout only needs the same WIDTH_BITS, get and set.
+template <typename T>
+struct ArrayLeaf {
+    static const unsigned WIDTH_BITS = 5;
+    T values[1u << WIDTH_BITS];
+
+    T get(unsigned index) const {
+        return values[index];
+    }
+
+    void set(unsigned index, const T& value) {
+        values[index] = value;
+    }
+};
+
+// Fixed-size vector stored as a radix trie of BRANCHING-wide nodes. Copies
+// share every node, so forking a vector is O(1); a write copies only the
+// nodes on the path to the written element, and only if they are shared.
+// Nodes come from the given arena, or from the heap without one.
+template <typename T, typename LeafStorage = ArrayLeaf<T>>
+class PersistentVector {
+    public:
+        static const unsigned BRANCHING_BITS = LeafStorage::WIDTH_BITS;
+        static const unsigned BRANCHING = 1u << BRANCHING_BITS;
+
+        PersistentVector() : count(0), levels(0), arena(nullptr) {}
+
+        PersistentVector(size_t size, const T& value, Arena* arena) : count(size), levels(0), arena(arena) {
+            size_t capacity = BRANCHING;
+            while (capacity < count) {
+                capacity *= BRANCHING;
+                ++levels;
+            }
+            // Every subtree of a level starts out identical, so build one per level
+            std::shared_ptr<Leaf> leaf = newNode<Leaf>(Leaf());
+            for (unsigned i = 0; i < BRANCHING; ++i) {
+                leaf->storage.set(i, value);
+            }
+            root = leaf;
+            for (unsigned level = 0; level < levels; ++level) {
+                std::shared_ptr<Branch> branch = newNode<Branch>(Branch());
+                for (unsigned i = 0; i < BRANCHING; ++i) {
+                    branch->children[i] = root;
+                }
+                root = branch;
+            }
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        T operator[](size_t index) const {
+            const Node* node = root.get();
+            for (unsigned level = levels; level > 0; --level) {
+                node = static_cast<const Branch*>(node)->children[childIndex(index, level)].get();
+            }
+            return static_cast<const Leaf*>(node)->storage.get(index & (BRANCHING - 1));
+        }
+
+        void set(size_t index, const T& value) {
+            std::shared_ptr<Node>* node = &root;
+            for (unsigned level = levels; level > 0; --level) {
+                makeUnique<Branch>(*node);
+                node = &static_cast<Branch*>(node->get())->children[childIndex(index, level)];
+            }
+            makeUnique<Leaf>(*node);
+            static_cast<Leaf*>(node->get())->storage.set(index & (BRANCHING - 1), value);
+        }
+
+        // Combines every element with the one at the same index in other through
+        // combine(T& mine, const T& theirs), which returns true when it changed
+        // mine. Subtrees both vectors share are skipped, so the cost follows the
+        // size of the difference rather than the size of the vector.
+        template <typename Combine>
+        bool combineWith(const PersistentVector& other, Combine combine) {
+            return combineLeavesWith(other, [&combine](LeafStorage& mine, const LeafStorage& theirs) {
+                bool changed = false;
+                for (unsigned i = 0; i < BRANCHING; ++i) {
+                    T value = mine.get(i);
+                    if (combine(value, theirs.get(i))) {
+                        mine.set(i, value);
+                        changed = true;
+                    }
+                }
+                return changed;
+            });
+        }
+
+        // Same, a whole leaf at a time through combine(LeafStorage& mine,
+        // const LeafStorage& theirs). Slots past size() take part too, they
+        // hold the initial value in both vectors.
+        template <typename Combine>
+        bool combineLeavesWith(const PersistentVector& other, Combine combine) {
+            return combineNode(root, other.root, levels, combine);
+        }
+
+        // True when test(const LeafStorage& mine, const LeafStorage& theirs)
+        // holds for every pair of leaves the two vectors do not share
+        template <typename Test>
+        bool testLeavesWith(const PersistentVector& other, Test test) const {
+            return testNode(root, other.root, levels, test);
+        }
+
+    private:
+        struct Node {};
+        struct Branch : Node {
+            std::shared_ptr<Node> children[BRANCHING];
+        };
+        struct Leaf : Node {
+            LeafStorage storage;
+        };
+
+        std::shared_ptr<Node> root;
+        size_t count;
+        unsigned levels;
+        Arena* arena;
+
+        template <typename NodeType>
+        std::shared_ptr<NodeType> newNode(const NodeType& node) const {
+            return std::allocate_shared<NodeType>(ArenaAllocator<NodeType>(arena), node);
+        }
+
+        static unsigned childIndex(size_t index, unsigned level) {
+            return (index >> (level * BRANCHING_BITS)) & (BRANCHING - 1);
+        }
+
+        template <typename NodeType>
+        void makeUnique(std::shared_ptr<Node>& node) const {
+            if (node.use_count() != 1) {
+                node = newNode<NodeType>(*static_cast<NodeType*>(node.get()));
+            }
+        }
+
+        template <typename Combine>
+        bool combineNode(std::shared_ptr<Node>& mine, const std::shared_ptr<Node>& theirs, unsigned level, Combine& combine) {
+            if (mine == theirs) {
+                return false;
+            }
+            if (level == 0) {
+                const LeafStorage* theirLeaf = &static_cast<const Leaf*>(theirs.get())->storage;
+                // A leaf nobody else holds is combined in place, a shared one
+                // into a copy that only replaces it when something changed
+                if (mine.use_count() == 1) {
+                    return combine(static_cast<Leaf*>(mine.get())->storage, *theirLeaf);
+                }
+                Leaf combined(*static_cast<const Leaf*>(mine.get()));
+                if (!combine(combined.storage, *theirLeaf)) {
+                    return false;
+                }
+                mine = newNode<Leaf>(combined);
+                return true;
+            }
+
+            bool changed = false;
+            const Branch* theirBranch = static_cast<const Branch*>(theirs.get());
+            bool unique = mine.use_count() == 1;
+            for (unsigned i = 0; i < BRANCHING; ++i) {
+                std::shared_ptr<Node> child = static_cast<Branch*>(mine.get())->children[i];
+                if (child == theirBranch->children[i]) {
+                    continue;
+                }
+                // Hand the only reference to the child down so it can be
+                // updated in place; a shared parent is only copied once
+                // something below it actually changes
+                if (unique) {
+                    static_cast<Branch*>(mine.get())->children[i].reset();
+                }
+                if (combineNode(child, theirBranch->children[i], level - 1, combine) && !changed) {
+                    makeUnique<Branch>(mine);
+                    changed = true;
+                    unique = true;
+                }
+                if (unique) {
+                    static_cast<Branch*>(mine.get())->children[i] = child;
+                }
+            }
+            return changed;
+        }
+
+        template <typename Test>
+        bool testNode(const std::shared_ptr<Node>& mine, const std::shared_ptr<Node>& theirs, unsigned level, Test& test) const {
+            if (mine == theirs) {
+                return true;
+            }
+            if (level == 0) {
+                return test(static_cast<const Leaf*>(mine.get())->storage, static_cast<const Leaf*>(theirs.get())->storage);
+            }
+            for (unsigned i = 0; i < BRANCHING; ++i) {
+                if (!testNode(static_cast<const Branch*>(mine.get())->children[i], static_cast<const Branch*>(theirs.get())->children[i], level - 1, test)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef PROFLR_H
+#define PROFLR_H
+
+// Instrumentation is only compiled in with -DINTERVAL_PROFILING. Without it
+// every PROFILE_* macro expands to nothing and its arguments are never
+// evaluated, so the analysis pays nothing for it.
+#ifdef INTERVAL_PROFILING
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Profiler {
+    public:
+        static Profiler& get();
+        static uint64_t now();
+
+        void recordSpan(const char* category, const char* name, uint64_t start, uint64_t duration);
+        void recordBlockVisit(const std::string& blockName, unsigned stateSize);
+        bool writeSummary(const char* path);
+        bool writeTrace(const char* path);
+
+    private:
+        typedef struct {
+            const char* category;
+            const char* name;
+            uint64_t start;
+            uint64_t duration;
+        } span_t;
+
+        typedef struct {
+            std::string blockName;
+            unsigned stateSize;
+            uint64_t time;
+        } block_visit_t;
+
+        // Every thread appends to its own buffer, buffers are only merged when written out
+        typedef struct {
+            unsigned threadIndex;
+            std::vector<span_t> spans;
+            std::vector<block_visit_t> blockVisits;
+        } thread_buffer_t;
+
+        std::mutex buffersLock;
+        std::vector<std::unique_ptr<thread_buffer_t>> buffers;
+        uint64_t origin;
+
+        Profiler();
+        thread_buffer_t* getThreadBuffer();
+};
+
+// Times the enclosing scope as one span of the given category
+class ProfileScope {
+    public:
+        ProfileScope(const char* category, const char* name) : category(category), name(name), start(Profiler::now()) {
+        }
+
+        ~ProfileScope() {
+            Profiler::get().recordSpan(category, name, start, Profiler::now() - start);
+        }
+
+    private:
+        const char* category;
+        const char* name;
+        uint64_t start;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(category, name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(category, name)
+#define PROFILE_BLOCK_VISIT(blockName, stateSize) Profiler::get().recordBlockVisit(blockName, stateSize)
+
+#else
+
+#define PROFILE_SCOPE(category, name)
+#define PROFILE_BLOCK_VISIT(blockName, stateSize)
+
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef RPTWRT_H
+#define RPTWRT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Tracker/Interval.h"
+
+// Collects the final interval report in memory and emits it with a single
+// write. Infinite bounds are explicit in both formats instead of NaN.
+//
+// JSON: {"version": 2, "intervals": [{"file", "function", "variable",
+// "context", "lower", "upper"}, ...]} where an infinite bound is the string
+// "-inf" or "+inf" and a finite one is a number.
+//
+// Binary, all integers little-endian:
+//   "ITVR" u32 version
+//   u32 string count, then per string: u32 length and its bytes
+//   u32 record count, then per record: u32 file, function, variable and
+//   context string indices, u8 flags (1 = lower is -inf, 2 = upper is +inf),
+//   i64 lower, i64 upper (0 when infinite)
+class ReportWriter {
+    public:
+        enum Format {
+            JSON,
+            BINARY
+        };
+
+        static bool parseFormat(const char* name, Format* format);
+
+        ReportWriter(Format format);
+        void addInterval(const std::string& file, const std::string& function, const std::string& variable, const std::string& context, Interval::interval_t interval);
+        bool write(FILE* stream);
+        unsigned getRecordCount() const;
+
+    private:
+        Format format;
+        std::string records;
+        unsigned recordCount;
+        std::unordered_map<std::string, uint32_t> stringIndices;
+        std::vector<const std::string*> strings;
+
+        uint32_t internString(const std::string& text);
+        void appendJsonString(const std::string& text);
+        void appendJsonBound(int64_t bound, const char* infinity);
+        void appendInteger(std::string* buffer, uint64_t value, unsigned bytes);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef STKERN_H
+#define STKERN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Lattice operations over whole rows of intervals stored as structure of
+// arrays, lower bounds in one array and upper bounds in another, so that a
+// row compares and combines several bounds per instruction. Every kernel has
+// a scalar version and, on x86, SSE4.2 and AVX2 versions; get() hands out the
+// widest one the CPU supports, picked once on first use.
+//
+// combine kernels update lower/upper with other and return true when any
+// bound changed. meet leaves lower > upper where two intervals are disjoint.
+// widen moves each growing bound to the nearest of the sorted thresholds
+// beyond it, or to infinity. includes is true when every interval of other
+// lies within this row, that is when a join would change nothing.
+class StateKernels {
+    public:
+        typedef enum {
+            SCALAR,
+            SSE42,
+            AVX2
+        } level_t;
+
+        typedef bool (*combine_t)(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count);
+        typedef bool (*widen_t)(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count,
+                                const int64_t* thresholds, size_t thresholdCount);
+        typedef bool (*test_t)(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count);
+
+        typedef struct {
+            level_t level;
+            const char* name;
+            combine_t join;
+            combine_t meet;
+            widen_t widen;
+            combine_t narrow;
+            test_t includes;
+            test_t equals;
+        } kernels_t;
+
+        static const kernels_t& get();
+        // nullptr when this CPU or build cannot run the level
+        static const kernels_t* get(level_t level);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,18 @@
+#ifndef STRUTL_H
+#define STRUTL_H
+
+#include <string>
+
+// Parsing and escaping shared by the analyzer, its report writers and the
+// benchmark tools. Parsers take digits only, so a sign, blank or exponent is
+// rejected instead of wrapping around, and return false on any bad input.
+class StringUtils {
+    public:
+        static bool parseCount(const char* text, unsigned* count);
+        static bool parseDecimal(const char* text, double* value);
+        // Escapes quotes, backslashes and control characters, without the
+        // surrounding quotes
+        static std::string escapeJson(const std::string& text);
+};
+
+#endif
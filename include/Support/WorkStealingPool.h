@@ -0,0 +1,47 @@
+#ifndef WSPOOL_H
+#define WSPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers, each owning a task deque. A worker pops from the back
+// of its own deque and steals from the front of the others once it runs dry.
+class WorkStealingPool {
+    public:
+        typedef std::function<void()> task_t;
+
+        WorkStealingPool(unsigned workerCount);
+        ~WorkStealingPool();
+        void submit(task_t task);
+        void wait();
+        unsigned getWorkerCount() const;
+        unsigned getStealCount() const;
+
+    private:
+        typedef struct {
+            std::mutex lock;
+            std::deque<task_t> tasks;
+        } worker_queue_t;
+
+        std::vector<std::unique_ptr<worker_queue_t>> queues;
+        std::vector<std::thread> workers;
+        std::mutex stateLock;
+        std::condition_variable taskAvailable;
+        std::condition_variable tasksDone;
+        std::atomic<unsigned> nextQueue;
+        std::atomic<unsigned> stealCount;
+        unsigned pendingTasks;
+        unsigned queuedTasks;
+        bool stopping;
+
+        void runWorker(unsigned workerIndex);
+        bool takeTask(unsigned workerIndex, task_t* task);
+};
+
+#endif
\ No newline at end of file
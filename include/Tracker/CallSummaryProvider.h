@@ -0,0 +1,22 @@
+#ifndef CALSUM_H
+#define CALSUM_H
+
+#include <vector>
+#include "llvm/IR/Function.h"
+#include "Interval.h"
+
+using namespace llvm;
+
+// Tells a tracker what a call to a defined function returns. Implemented by
+// the interprocedural analysis, which sits above the trackers.
+class CallSummaryProvider {
+    public:
+        typedef Interval::interval_t interval_t;
+
+        virtual ~CallSummaryProvider(){}
+
+        // Returns false when the callee never returns for these arguments
+        virtual bool getReturnInterval(const Function* caller, const Function* callee, const std::vector<interval_t>& arguments, interval_t* result) const = 0;
+};
+
+#endif
\ No newline at end of file
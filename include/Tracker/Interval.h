@@ -0,0 +1,126 @@
+#ifndef INTRVL_H
+#define INTRVL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Closed range of signed 64-bit integers. The two extreme values of the type
+// stand for -infinity and +infinity, so an unbounded side needs no flag and
+// an interval stays a 16 byte POD that states can pack densely. Bound
+// arithmetic saturates: a side that is infinite or overflows becomes that
+// side's infinity, without testing each operand separately.
+class Interval {
+    public:
+        typedef struct {
+            int64_t lower;
+            int64_t upper;
+        } interval_t;
+
+        static const int64_t MINUS_INFINITY = INT64_MIN;
+        static const int64_t PLUS_INFINITY = INT64_MAX;
+
+        static interval_t make(int64_t lower, int64_t upper) {
+            return {lower, upper};
+        }
+
+        static interval_t constant(int64_t value) {
+            return {value, value};
+        }
+
+        static interval_t top() {
+            return {MINUS_INFINITY, PLUS_INFINITY};
+        }
+
+        static bool isInfinite(int64_t bound) {
+            return (bound == MINUS_INFINITY) | (bound == PLUS_INFINITY);
+        }
+
+        static bool isTop(interval_t interval) {
+            return (interval.lower == MINUS_INFINITY) & (interval.upper == PLUS_INFINITY);
+        }
+
+        static bool isFinite(interval_t interval) {
+            return !isInfinite(interval.lower) & !isInfinite(interval.upper);
+        }
+
+        static bool isConstant(interval_t interval) {
+            return (interval.lower == interval.upper) & !isInfinite(interval.lower);
+        }
+
+        static bool isSame(interval_t first, interval_t second) {
+            return (first.lower == second.lower) & (first.upper == second.upper);
+        }
+
+        // Bound arithmetic, infinity is the value the result saturates to
+        static int64_t addBounds(int64_t first, int64_t second, int64_t infinity) {
+            int64_t sum;
+            bool overflow = __builtin_add_overflow(first, second, &sum);
+            return (overflow | isInfinite(first) | isInfinite(second)) ? infinity : sum;
+        }
+
+        static int64_t subBounds(int64_t first, int64_t second, int64_t infinity) {
+            int64_t difference;
+            bool overflow = __builtin_sub_overflow(first, second, &difference);
+            return (overflow | isInfinite(first) | isInfinite(second)) ? infinity : difference;
+        }
+
+        static int64_t mulBounds(int64_t first, int64_t second) {
+            // Zero absorbs even an infinite factor, otherwise the signs pick the infinity
+            int64_t product;
+            bool overflow = __builtin_mul_overflow(first, second, &product);
+            int64_t infinity = ((first < 0) != (second < 0)) ? MINUS_INFINITY : PLUS_INFINITY;
+            product = (overflow | isInfinite(first) | isInfinite(second)) ? infinity : product;
+            return ((first == 0) | (second == 0)) ? 0 : product;
+        }
+
+        static interval_t add(interval_t first, interval_t second) {
+            return {addBounds(first.lower, second.lower, MINUS_INFINITY), addBounds(first.upper, second.upper, PLUS_INFINITY)};
+        }
+
+        static interval_t sub(interval_t first, interval_t second) {
+            return {subBounds(first.lower, second.upper, MINUS_INFINITY), subBounds(first.upper, second.lower, PLUS_INFINITY)};
+        }
+
+        static interval_t mul(interval_t first, interval_t second) {
+            // Either sign may flip the ordering, so consider every corner product
+            int64_t products[] = {mulBounds(first.lower, second.lower), mulBounds(first.lower, second.upper),
+                                  mulBounds(first.upper, second.lower), mulBounds(first.upper, second.upper)};
+            return {*std::min_element(products, products + 4), *std::max_element(products, products + 4)};
+        }
+
+        // Smallest and largest value of an integer type, i1 holds 0 and 1
+        static int64_t getTypeMin(unsigned bits) {
+            return (bits == 1) ? 0 : ((bits >= 64) ? MINUS_INFINITY : -(INT64_C(1) << (bits - 1)));
+        }
+
+        static int64_t getTypeMax(unsigned bits) {
+            return (bits == 1) ? 1 : ((bits >= 64) ? PLUS_INFINITY : (INT64_C(1) << (bits - 1)) - 1);
+        }
+
+        // A finite bound outside its type means the operation may have wrapped
+        // around, after which the result can be anywhere. So does a bound that
+        // saturated to the opposite side's infinity, i64 has no room to spare.
+        static interval_t fitToWidth(interval_t interval, unsigned bits) {
+            bool lowerOutside = !isInfinite(interval.lower) & (interval.lower < getTypeMin(bits));
+            bool upperOutside = !isInfinite(interval.upper) & (interval.upper > getTypeMax(bits));
+            bool collapsed = (interval.lower == PLUS_INFINITY) | (interval.upper == MINUS_INFINITY);
+            return (lowerOutside | upperOutside | collapsed) ? top() : interval;
+        }
+
+        // Formats a bound exactly, or as a signed infinity. The ".000000"
+        // suffix is appended as text so reports keep the layout of the
+        // former "%f" bounds
+        static std::string formatBound(int64_t bound) {
+            if (isInfinite(bound)) {
+                return (bound == MINUS_INFINITY) ? "-infinity" : "+infinity";
+            }
+            return std::to_string(bound) + ".000000";
+        }
+};
+
+static_assert((sizeof(Interval::interval_t) == 16) && std::is_trivially_copyable<Interval::interval_t>::value &&
+              std::is_standard_layout<Interval::interval_t>::value, "intervals are stored as plain pairs of bounds");
+
+#endif
\ No newline at end of file
@@ -1,60 +1,127 @@
 #ifndef ITVTRK_H
 #define ITVTRK_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
-#include <tuple>
-#include <functional>
+#include <vector>
+#include "llvm/IR/Constants.h"
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#include "CallSummaryProvider.h"
+#include "Interval.h"
 #include "Tracker.h"
+#include "SlotNumbering.h"
 #include "ValueTracker.h"
+#include "../Support/Arena.h"
+#include "../Support/PersistentVector.h"
+#include "../Support/StateKernels.h"
 
 using namespace llvm;
 
 class IntervalTracker : public Tracker {
     public:
-        typedef std::tuple<double, double> interval_t;
+        typedef Interval::interval_t interval_t;
         typedef std::unordered_map<std::string, interval_t> var_map_t;
         typedef std::unordered_map<std::string, interval_t>::iterator var_it_t;
         typedef std::pair<std::string, interval_t> var_t;
-        typedef std::function<interval_t(interval_t, interval_t)> arithmetic_function_t;
+        // One leaf of the state, lower and upper bounds in separate rows so
+        // the state kernels combine whole leaves at a time
+        struct bound_rows_t {
+            static const unsigned WIDTH_BITS = 5;
+            static const unsigned WIDTH = 1u << WIDTH_BITS;
+            int64_t lower[WIDTH];
+            int64_t upper[WIDTH];
 
-        // Static methods
-        static var_t getVarEntryFromPtr(void* ptr);
+            interval_t get(unsigned index) const {
+                return Interval::make(lower[index], upper[index]);
+            }
+
+            void set(unsigned index, interval_t interval) {
+                lower[index] = interval.lower;
+                upper[index] = interval.upper;
+            }
+        };
+        typedef PersistentVector<interval_t, bound_rows_t> slot_state_t;
+        typedef interval_t (IntervalTracker::*transfer_t)(interval_t, interval_t);
+
+        IntervalTracker(const SlotNumbering* slots, Arena* arena);
 
         // Instance-bound methods
-        void* getPtrFromVariableName(std::string name);
+        interval_t getVariableInterval(int slot) const;
         interval_t getVariableInterval(std::string name) const;
-        double getVariableValue(std::string name);
+        double getVariableValue(int slot) const;
+        double getVariableValue(std::string name) const;
+        const SlotNumbering* getSlotNumbering() const;
         var_map_t getIntervalsTracker() const;
+        unsigned getBoundedIntervalCount() const;
         ValueTracker::var_map_t getValueTracker() const;
-        void setTracker(ValueTracker::var_map_t tracker);
-        void setTracker(IntervalTracker::var_map_t tracker);
-        void setTracker(IntervalTracker::var_map_t iTracker, ValueTracker::var_map_t vTracker);
         void switchLoopState(bool state);
         bool isInLoop() const;
+        void setCallSummaries(const CallSummaryProvider* summaries);
+        bool isUnreachable() const;
+        interval_t getOperandInterval(Value* operand) const;
+        void setValueInterval(const Value* value, interval_t interval);
+        interval_t calculateInterval(unsigned opcode, interval_t first, interval_t second, unsigned bits);
+        bool refineBranch(const BranchInst* branch, unsigned successor);
+
+        // Lattice operations used by the fixpoint engine
+        static interval_t joinInterval(interval_t first, interval_t second);
+        static interval_t widenInterval(interval_t previous, interval_t next, const std::vector<int64_t>& thresholds);
+        static interval_t narrowInterval(interval_t previous, interval_t next);
+        static bool isSameInterval(interval_t first, interval_t second);
+        static interval_t castInterval(unsigned opcode, interval_t source, unsigned sourceBits, unsigned destBits);
+        static interval_t compareInterval(CmpInst::Predicate predicate, interval_t first, interval_t second);
+        static bool refineComparison(CmpInst::Predicate predicate, interval_t* first, interval_t* second);
+        static interval_t getConstantInterval(const ConstantInt* constant);
+        bool joinTracker(const IntervalTracker& other);
+        bool widenTracker(const IntervalTracker& other, const std::vector<int64_t>& thresholds);
+        bool narrowTracker(const IntervalTracker& other);
+        bool includesTracker(const IntervalTracker& other) const;
 
         // Tracker methods
         void printTracker() override;
-        void* processNewEntry(Instruction *i) override;
-        void* allocateNewVariable(AllocaInst* i) override;
-        void* storeValueIntoVariable(StoreInst* i) override;
-        void* loadVariableIntoRegister(LoadInst* i) override;
-        void* compareValues(CmpInst* i) override;
-        void* processCalculation(BinaryOperator* i) override;
+        int processNewEntry(Instruction *i) override;
+        int allocateNewVariable(AllocaInst* i) override;
+        int storeValueIntoVariable(StoreInst* i) override;
+        int loadVariableIntoRegister(LoadInst* i) override;
+        int compareValues(CmpInst* i) override;
+        int processCalculation(BinaryOperator* i) override;
+        int processCast(CastInst* i) override;
+        int processSelect(SelectInst* i) override;
+        int processCall(CallInst* i) override;
 
     private:
         // Core tracker state
+        const SlotNumbering* slots;
         ValueTracker valueTracker;
-        var_map_t intervalsTracker;
-        bool loopState;
+        slot_state_t intervalsTracker;
+        bool loopState = false;
+        const CallSummaryProvider* callSummaries = nullptr;
+        // Set once a call that never returns is passed, nothing after it executes
+        bool unreachable = false;
+
+        interval_t admitValue(int slot, interval_t interval);
+        void refineOperand(const BranchInst* branch, const ICmpInst* compare, unsigned operand, interval_t interval);
+        void refineValue(const Value* value, interval_t interval);
 
-        // Caclulation helpers
-        var_t calculateArithmetic(Instruction* i, arithmetic_function_t callback);
+        // Caclulation helpers, bound to their opcode at compile time
+        template <transfer_t Callback>
+        int calculateArithmetic(Instruction* i);
         interval_t addCallback(interval_t accumulator, interval_t current);
         interval_t subCallback(interval_t accumulator, interval_t current);
         interval_t mulCallback(interval_t accumulator, interval_t current);
+        interval_t sdivCallback(interval_t accumulator, interval_t current);
+        interval_t udivCallback(interval_t accumulator, interval_t current);
         interval_t sremCallback(interval_t accumulator, interval_t current);
+        interval_t uremCallback(interval_t accumulator, interval_t current);
+        interval_t shlCallback(interval_t accumulator, interval_t current);
+        interval_t lshrCallback(interval_t accumulator, interval_t current);
+        interval_t ashrCallback(interval_t accumulator, interval_t current);
+        interval_t andCallback(interval_t accumulator, interval_t current);
+        interval_t orCallback(interval_t accumulator, interval_t current);
+        interval_t xorCallback(interval_t accumulator, interval_t current);
+        interval_t unknownCallback(interval_t accumulator, interval_t current);
 };
 
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef SLTNUM_H
+#define SLTNUM_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Value.h"
+
+using namespace llvm;
+
+// Numbers every value a tracker keeps state for (integer arguments, allocas,
+// loads, comparisons, arithmetic, integer casts, selects and integer calls)
+// so that abstract states can be dense arrays. It also records the allocas
+// whose address escapes, which any call may write.
+class SlotNumbering {
+    public:
+        static const int NO_SLOT = -1;
+
+        SlotNumbering(Function* function);
+        int getSlot(const Value* value) const;
+        int getSlot(std::string name) const;
+        const Value* getValue(unsigned slot) const;
+        std::string getSlotName(unsigned slot) const;
+        unsigned size() const;
+        std::vector<int> getClobberedSlots(const CallInst* call) const;
+
+    private:
+        std::vector<const Value*> slotValues;
+        DenseMap<const Value*, unsigned> valueSlots;
+        std::unordered_map<std::string, unsigned> namedSlots;
+        std::vector<int> escapedSlots;
+
+        void numberValue(const Value* value);
+};
+
+#endif
\ No newline at end of file
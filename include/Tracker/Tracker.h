@@ -2,20 +2,26 @@
 #define TRK_H
 
 #include "llvm/IR/Instruction.h"
+#include "llvm/IR/Instructions.h"
+#include "SlotNumbering.h"
 
 using namespace llvm;
 
+// Every transfer returns the slot it updated, or SlotNumbering::NO_SLOT
 class Tracker {
     public:
         virtual ~Tracker(){}
 
         virtual void printTracker() = 0;
-        virtual void* processNewEntry(Instruction *i) = 0;
-        virtual void* allocateNewVariable(AllocaInst* i) = 0;
-        virtual void* storeValueIntoVariable(StoreInst* i) = 0;
-        virtual void* loadVariableIntoRegister(LoadInst* i) = 0;
-        virtual void* compareValues(CmpInst* i) = 0;
-        virtual void* processCalculation(BinaryOperator* i) = 0;
+        virtual int processNewEntry(Instruction *i) = 0;
+        virtual int allocateNewVariable(AllocaInst* i) = 0;
+        virtual int storeValueIntoVariable(StoreInst* i) = 0;
+        virtual int loadVariableIntoRegister(LoadInst* i) = 0;
+        virtual int compareValues(CmpInst* i) = 0;
+        virtual int processCalculation(BinaryOperator* i) = 0;
+        virtual int processCast(CastInst* i) = 0;
+        virtual int processSelect(SelectInst* i) = 0;
+        virtual int processCall(CallInst* i) = 0;
 };
 
 #endif
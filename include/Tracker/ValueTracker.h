@@ -1,11 +1,15 @@
 #ifndef VALTRK_H
 #define VALTRK_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
-#include <functional>
+#include <vector>
 #include "llvm/IR/Instruction.h"
 #include "Tracker.h"
+#include "SlotNumbering.h"
+#include "../Support/Arena.h"
+#include "../Support/PersistentVector.h"
 
 using namespace llvm;
 
@@ -14,37 +18,61 @@ class ValueTracker : public Tracker {
         typedef std::unordered_map<std::string, double> var_map_t;
         typedef std::unordered_map<std::string, double>::iterator var_it_t;
         typedef std::pair<std::string, double> var_t;
-        typedef std::function<double(double, double)> arithmetic_function_t;
+        typedef PersistentVector<double> slot_state_t;
+        typedef double (ValueTracker::*transfer_t)(double, double);
+        // Largest magnitude a double still holds exactly, concrete values
+        // beyond it are unknown
+        static const int64_t MAX_EXACT_VALUE = (INT64_C(1) << 53) - 1;
 
-        // Static methods
-        static var_t getVariableFromPtr(void* ptr);
+        ValueTracker(const SlotNumbering* slots, Arena* arena);
 
         // Instance-bound methods
-        void* getPtrFromVariableName(std::string name);
-        double getVariableValue(std::string name);
-        void editVariable(std::string name, double value);
+        double getVariableValue(int slot) const;
+        double getVariableValue(std::string name) const;
+        double getOperandValue(Value* operand) const;
+        static bool isExact(double value);
+        static double toValue(int64_t number);
+        static double fitToWidth(double value, Type* type);
+        void editVariable(int slot, double value);
+        const SlotNumbering* getSlotNumbering() const;
         var_map_t getValueTracker() const;
-        void setTracker(var_map_t tracker);
+        bool joinTracker(const ValueTracker& other);
+        bool includesTracker(const ValueTracker& other) const;
 
         // Tracker methods
         void printTracker() override;
-        void* processNewEntry(Instruction *i) override;
-        void* allocateNewVariable(AllocaInst* i) override;
-        void* storeValueIntoVariable(StoreInst* i) override;
-        void* loadVariableIntoRegister(LoadInst* i) override;
-        void* compareValues(CmpInst* i) override;
-        void* processCalculation(BinaryOperator* i) override;
+        int processNewEntry(Instruction *i) override;
+        int allocateNewVariable(AllocaInst* i) override;
+        int storeValueIntoVariable(StoreInst* i) override;
+        int loadVariableIntoRegister(LoadInst* i) override;
+        int compareValues(CmpInst* i) override;
+        int processCalculation(BinaryOperator* i) override;
+        int processCast(CastInst* i) override;
+        int processSelect(SelectInst* i) override;
+        int processCall(CallInst* i) override;
 
     private:
         // Core tracker state
-        var_map_t variablesTracker;
+        const SlotNumbering* slots;
+        slot_state_t variablesTracker;
 
-        // Caclulation helpers
-        var_t calculateArithmetic(Instruction* i, arithmetic_function_t callback);
+        // Caclulation helpers, bound to their opcode at compile time
+        template <transfer_t Callback>
+        int calculateArithmetic(Instruction* i);
         double addCallback(double accumulator, double current);
         double subCallback(double accumulator, double current);
         double mulCallback(double accumulator, double current);
+        double sdivCallback(double accumulator, double current);
+        double udivCallback(double accumulator, double current);
         double sremCallback(double accumulator, double current);
+        double uremCallback(double accumulator, double current);
+        double shlCallback(double accumulator, double current);
+        double lshrCallback(double accumulator, double current);
+        double ashrCallback(double accumulator, double current);
+        double andCallback(double accumulator, double current);
+        double orCallback(double accumulator, double current);
+        double xorCallback(double accumulator, double current);
+        double unknownCallback(double accumulator, double current);
         double equalToCallback(double accumulator, double current);
         double notEqualToCallback(double accumulator, double current);
         double greaterThanCallback(double accumulator, double current);
@@ -53,4 +81,4 @@ class ValueTracker : public Tracker {
         double lessThanOrEqualCallback(double accumulator, double current);
 };
 
-#endif
+#endif
\ No newline at end of file
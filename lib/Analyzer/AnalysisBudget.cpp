@@ -0,0 +1,71 @@
+#include <chrono>
+#include "../../include/Analyzer/AnalysisBudget.h"
+
+AnalysisBudget::limits_t AnalysisBudget::getUnlimited() {
+    return {0, 0, 0, 0};
+}
+
+bool AnalysisBudget::isUnlimited(const limits_t& limits) {
+    return (limits.maxContexts == 0) && (limits.maxVisits == 0) && (limits.maxMemoryBytes == 0) && (limits.deadlineMilliseconds == 0);
+}
+
+const char* AnalysisBudget::getReasonName(Reason reason) {
+    switch (reason) {
+        case CONTEXTS:
+            return "contexts";
+        case VISITS:
+            return "visits";
+        case MEMORY:
+            return "memory";
+        case DEADLINE:
+            return "time";
+        default:
+            return "none";
+    }
+}
+
+AnalysisBudget::AnalysisBudget(const limits_t& limits)
+    : limits(limits), arena(nullptr), start(std::chrono::steady_clock::now()), contexts(0), visits(0), reason(WITHIN_BUDGET) {
+}
+
+void AnalysisBudget::trackArena(const Arena* arena) {
+    this->arena = arena;
+}
+
+bool AnalysisBudget::chargeContext() {
+    ++contexts;
+    return checkLimits();
+}
+
+bool AnalysisBudget::chargeVisit() {
+    ++visits;
+    return checkLimits();
+}
+
+bool AnalysisBudget::isExhausted() const {
+    return reason != WITHIN_BUDGET;
+}
+
+AnalysisBudget::Reason AnalysisBudget::getReason() const {
+    return reason;
+}
+
+bool AnalysisBudget::checkLimits() {
+    if (reason != WITHIN_BUDGET) {
+        return false;
+    }
+    if ((limits.maxContexts != 0) && (contexts > limits.maxContexts)) {
+        reason = CONTEXTS;
+    }
+    else if ((limits.maxVisits != 0) && (visits > limits.maxVisits)) {
+        reason = VISITS;
+    }
+    else if ((limits.maxMemoryBytes != 0) && (arena != nullptr) && (arena->getPeakBytesInUse() > limits.maxMemoryBytes)) {
+        reason = MEMORY;
+    }
+    else if ((limits.deadlineMilliseconds != 0) &&
+             (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() > limits.deadlineMilliseconds)) {
+        reason = DEADLINE;
+    }
+    return reason == WITHIN_BUDGET;
+}
@@ -0,0 +1,35 @@
+#include <string>
+#include <vector>
+#include "../../include/Analyzer/ContextTrie.h"
+
+#define DEPTH_SEPARATOR '/'
+
+ContextTrie::ContextTrie(std::string functionName) : functionName(functionName) {
+    nodes.push_back({ROOT, nullptr, 0});
+}
+
+ContextTrie::context_id_t ContextTrie::getChild(context_id_t parent, const BasicBlock* BB) {
+    auto inserted = children.insert(std::make_pair(std::make_pair(parent, BB), static_cast<context_id_t>(nodes.size())));
+    if (inserted.second) {
+        nodes.push_back({parent, BB, nodes[parent].depth + 1});
+    }
+    return inserted.first->second;
+}
+
+unsigned ContextTrie::getDepth(context_id_t context) const {
+    return nodes[context].depth;
+}
+
+std::string ContextTrie::getName(context_id_t context) const {
+    // Walk up to the root, then join the block names from the top down
+    std::vector<const BasicBlock*> path;
+    for (; context != ROOT; context = nodes[context].parent) {
+        path.push_back(nodes[context].block);
+    }
+    std::string name = functionName;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        name += DEPTH_SEPARATOR;
+        name += (*it)->getName().str();
+    }
+    return name;
+}
@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../../include/Analyzer/FunctionHasher.h"
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+uint64_t FunctionHasher::hashBytes(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t byte = 0; byte < size; ++byte) {
+        hash ^= bytes[byte];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t FunctionHasher::hashString(const std::string& text, uint64_t seed) {
+    // The length keeps "ab" + "c" apart from "a" + "bc"
+    return hashBytes(text.data(), text.size(), hashInteger(text.size(), seed));
+}
+
+uint64_t FunctionHasher::getSeed() {
+    return FNV_OFFSET_BASIS;
+}
+
+uint64_t FunctionHasher::getStructuralHash(const Function* F) {
+    auto cached = structuralHashes.find(F);
+    if (cached != structuralHashes.end()) {
+        return cached->second;
+    }
+
+    // Arguments, blocks and instructions are referred to by their position
+    std::unordered_map<const Value*, uint64_t> localNumbers;
+    for (auto& argument : F->args()) {
+        localNumbers[&argument] = localNumbers.size();
+    }
+    for (auto& BB : *F) {
+        localNumbers[&BB] = localNumbers.size();
+        for (auto& I : BB) {
+            localNumbers[&I] = localNumbers.size();
+        }
+    }
+
+    std::string typeName;
+    raw_string_ostream typeStream(typeName);
+    F->getFunctionType()->print(typeStream);
+    uint64_t hash = hashString(F->getName().str(), getSeed());
+    hash = hashString(typeStream.str(), hash);
+    for (auto& BB : *F) {
+        hash = hashString(BB.getName().str(), hash);
+        for (auto& I : BB) {
+            hash = hashInteger(I.getOpcode(), hash);
+            hash = hashString(I.getName().str(), hash);
+            hash = hashInteger(I.getType()->getTypeID(), hash);
+            if (I.getType()->isIntegerTy()) {
+                hash = hashInteger(I.getType()->getIntegerBitWidth(), hash);
+            }
+            if (const CmpInst* cmpInst = dyn_cast<CmpInst>(&I)) {
+                hash = hashInteger(cmpInst->getPredicate(), hash);
+            }
+            if (const AllocaInst* allocaInst = dyn_cast<AllocaInst>(&I)) {
+                hash = hashInteger(allocaInst->getAllocatedType()->getTypeID(), hash);
+            }
+            // What a call may write is read from its attributes and its callee's
+            if (const CallBase* call = dyn_cast<CallBase>(&I)) {
+                hash = hashAttributes(call->getAttributes(), call->arg_size(), hash);
+                if (const Function* callee = call->getCalledFunction()) {
+                    hash = hashAttributes(callee->getAttributes(), callee->arg_size(), hash);
+                }
+            }
+            hash = hashInteger(I.getNumOperands(), hash);
+            for (const Value* operand : I.operand_values()) {
+                hash = hashOperand(operand, localNumbers, hash);
+            }
+        }
+    }
+    structuralHashes[F] = hash;
+    return hash;
+}
+
+uint64_t FunctionHasher::getDependencyHash(const Function* F) {
+    // Collect every defined function reachable through direct calls, cycles included
+    std::set<const Function*> reachable;
+    std::vector<const Function*> pending(1, F);
+    while (!pending.empty()) {
+        const Function* current = pending.back();
+        pending.pop_back();
+        for (auto& BB : *current) {
+            for (auto& I : BB) {
+                const CallBase* call = dyn_cast<CallBase>(&I);
+                const Function* callee = call ? call->getCalledFunction() : nullptr;
+                if (callee && !callee->isDeclaration() && (callee != F) && reachable.insert(callee).second) {
+                    pending.push_back(callee);
+                }
+            }
+        }
+    }
+
+    // Callees are mixed in by name order so the hash does not depend on discovery order
+    std::vector<const Function*> callees(reachable.begin(), reachable.end());
+    std::sort(callees.begin(), callees.end(), [](const Function* a, const Function* b) {
+        return a->getName() < b->getName();
+    });
+    uint64_t hash = getStructuralHash(F);
+    for (const Function* callee : callees) {
+        hash = hashInteger(getStructuralHash(callee), hash);
+    }
+    return hash;
+}
+
+uint64_t FunctionHasher::hashOperand(const Value* operand, const std::unordered_map<const Value*, uint64_t>& localNumbers, uint64_t seed) {
+    auto local = localNumbers.find(operand);
+    if (local != localNumbers.end()) {
+        return hashInteger(local->second, hashInteger(1, seed));
+    }
+    if (const ConstantInt* numConstant = dyn_cast<ConstantInt>(operand)) {
+        uint64_t hash = hashInteger(numConstant->getBitWidth(), hashInteger(2, seed));
+        return hashInteger(numConstant->getValue().getLimitedValue(), hash);
+    }
+    if (const GlobalValue* global = dyn_cast<GlobalValue>(operand)) {
+        return hashString(global->getName().str(), hashInteger(3, seed));
+    }
+    // Anything else is rare enough to hash by its printed form
+    std::string text;
+    raw_string_ostream textStream(text);
+    operand->print(textStream);
+    return hashString(textStream.str(), hashInteger(4, seed));
+}
+
+uint64_t FunctionHasher::hashAttributes(const AttributeList& attributes, unsigned argumentCount, uint64_t seed) {
+    uint64_t hash = hashString(attributes.getAsString(AttributeList::FunctionIndex), seed);
+    hash = hashString(attributes.getAsString(AttributeList::ReturnIndex), hash);
+    for (unsigned argument = 0; argument < argumentCount; ++argument) {
+        hash = hashString(attributes.getAsString(AttributeList::FirstArgIndex + argument), hash);
+    }
+    return hash;
+}
+
+uint64_t FunctionHasher::hashInteger(uint64_t value, uint64_t seed) {
+    return hashBytes(&value, sizeof(value), seed);
+}
\ No newline at end of file
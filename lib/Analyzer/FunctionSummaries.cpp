@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <set>
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Error.h"
+#include "../../include/Analyzer/FunctionSummaries.h"
+#include "../../include/Analyzer/IntervalAnalyzer.h"
+#include "../../include/Support/Arena.h"
+#include "../../include/Support/Profiler.h"
+#include "../../include/Support/WorkStealingPool.h"
+#include "../../include/Tracker/SlotNumbering.h"
+
+// Recursive components join their first few iterations before widening
+#define WIDENING_DELAY 2
+// Argument-specific results kept per function, later calls use the summary
+#define SPECIALIZATION_LIMIT 64
+
+static CallSummaryProvider::interval_t topInterval() {
+    return Interval::top();
+}
+
+static bool isTopInterval(CallSummaryProvider::interval_t interval) {
+    return Interval::isTop(interval);
+}
+
+// Both intervals hold the value, so it lies in their intersection
+static CallSummaryProvider::interval_t meetInterval(CallSummaryProvider::interval_t general, CallSummaryProvider::interval_t specific) {
+    CallSummaryProvider::interval_t met = Interval::make(std::max(general.lower, specific.lower), std::min(general.upper, specific.upper));
+    return (met.lower > met.upper) ? specific : met;
+}
+
+FunctionSummaries::FunctionSummaries(const WorklistEngine::widening_options_t& options, const AnalysisBudget::limits_t& limits)
+    : options(options), limits(limits) {
+}
+
+bool FunctionSummaries::collect(const std::vector<Function*>& roots, std::string* error) {
+    // Walks the direct calls out of the roots, reading lazily loaded bodies on the way
+    std::vector<unsigned> pending;
+    auto addFunction = [this, &pending](Function* F) {
+        auto found = functionIndices.find(F);
+        if (found != functionIndices.end()) {
+            return found->second;
+        }
+        unsigned index = functions.size();
+        functionIndices[F] = index;
+        functions.push_back(F);
+        callees.push_back(std::vector<unsigned>());
+        called.push_back(false);
+        pending.push_back(index);
+        return index;
+    };
+    for (Function* F : roots) {
+        addFunction(F);
+    }
+    while (!pending.empty()) {
+        unsigned index = pending.back();
+        pending.pop_back();
+        Function* F = functions[index];
+        if (F->isMaterializable()) {
+            if (Error materializeError = F->materialize()) {
+                *error = toString(std::move(materializeError));
+                return false;
+            }
+        }
+        std::set<unsigned> calleeIndices;
+        for (auto& BB : *F) {
+            for (auto& I : BB) {
+                CallInst* call = dyn_cast<CallInst>(&I);
+                Function* callee = call ? call->getCalledFunction() : nullptr;
+                if ((callee != nullptr) && !callee->isDeclaration()) {
+                    calleeIndices.insert(addFunction(callee));
+                }
+            }
+        }
+        for (unsigned calleeIndex : calleeIndices) {
+            called[calleeIndex] = true;
+        }
+        callees[index].assign(calleeIndices.begin(), calleeIndices.end());
+    }
+    computeComponents();
+    return true;
+}
+
+void FunctionSummaries::build(unsigned jobs) {
+    PROFILE_SCOPE("engine", "FunctionSummaries::build");
+    summaries.assign(functions.size(), {false, topInterval()});
+    specializationCounts.assign(functions.size(), 0);
+    if (jobs <= 1) {
+        // Components come out of Tarjan's algorithm callees first
+        for (unsigned component = 0; component < components.size(); ++component) {
+            if (isNeeded(component)) {
+                buildComponent(component);
+            }
+        }
+        return;
+    }
+
+    // A component is ready once every component it calls is done
+    std::vector<std::vector<unsigned>> dependents(components.size());
+    std::unique_ptr<std::atomic<unsigned>[]> pendingCallees(new std::atomic<unsigned>[components.size()]);
+    for (unsigned component = 0; component < components.size(); ++component) {
+        std::set<unsigned> calleeComponents;
+        for (unsigned member : components[component]) {
+            for (unsigned callee : callees[member]) {
+                if (functionComponents[callee] != component) {
+                    calleeComponents.insert(functionComponents[callee]);
+                }
+            }
+        }
+        pendingCallees[component] = calleeComponents.size();
+        for (unsigned calleeComponent : calleeComponents) {
+            dependents[calleeComponent].push_back(component);
+        }
+    }
+    WorkStealingPool pool(jobs);
+    std::function<void(unsigned)> runComponent = [this, &pool, &dependents, &pendingCallees, &runComponent](unsigned component) {
+        if (isNeeded(component)) {
+            buildComponent(component);
+        }
+        for (unsigned dependent : dependents[component]) {
+            if (pendingCallees[dependent].fetch_sub(1) == 1) {
+                pool.submit([&runComponent, dependent] { runComponent(dependent); });
+            }
+        }
+    };
+    for (unsigned component = 0; component < components.size(); ++component) {
+        if (pendingCallees[component] == 0) {
+            pool.submit([&runComponent, component] { runComponent(component); });
+        }
+    }
+    pool.wait();
+}
+
+bool FunctionSummaries::contains(const Function* function) const {
+    return functionIndices.count(function) != 0;
+}
+
+size_t FunctionSummaries::size() const {
+    return functions.size();
+}
+
+unsigned FunctionSummaries::getComponentCount() const {
+    unsigned count = 0;
+    for (unsigned component = 0; component < components.size(); ++component) {
+        count += isNeeded(component) ? 1 : 0;
+    }
+    return count;
+}
+
+unsigned FunctionSummaries::getRecursiveComponentCount() const {
+    unsigned count = 0;
+    for (unsigned component = 0; component < components.size(); ++component) {
+        count += (isNeeded(component) && isRecursive(component)) ? 1 : 0;
+    }
+    return count;
+}
+
+unsigned FunctionSummaries::getSpecializationCount() const {
+    std::lock_guard<std::mutex> guard(specializationsLock);
+    return specializations.size();
+}
+
+std::vector<FunctionSummaries::degradation_t> FunctionSummaries::getDegradations() const {
+    std::lock_guard<std::mutex> guard(degradationsLock);
+    std::vector<degradation_t> degraded;
+    for (auto& degradation : degradations) {
+        degraded.push_back(std::make_pair(functions[degradation.first], degradation.second));
+    }
+    return degraded;
+}
+
+bool FunctionSummaries::getReturnInterval(const Function* caller, const Function* callee, const std::vector<interval_t>& arguments, interval_t* result) const {
+    auto calleeIndex = functionIndices.find(callee);
+    if (calleeIndex == functionIndices.end()) {
+        *result = topInterval();
+        return true;
+    }
+    summary_t summary = summaries[calleeIndex->second];
+
+    // Calls inside a recursive component only ever see the summary being iterated
+    auto callerIndex = functionIndices.find(caller);
+    bool sameComponent = (callerIndex != functionIndices.end()) &&
+                         (functionComponents[callerIndex->second] == functionComponents[calleeIndex->second]);
+    bool knownArguments = std::any_of(arguments.begin(), arguments.end(), [](interval_t argument) { return !isTopInterval(argument); });
+    if (summary.returns && !sameComponent && knownArguments) {
+        summary_t specialized = getSpecialization(calleeIndex->second, arguments);
+        summary.returns = specialized.returns;
+        summary.returnInterval = meetInterval(summary.returnInterval, specialized.returnInterval);
+    }
+    *result = summary.returnInterval;
+    return summary.returns;
+}
+
+void FunctionSummaries::computeComponents() {
+    // Tarjan's algorithm, which emits a component only after every component it reaches
+    std::vector<int> visitOrder(functions.size(), -1);
+    std::vector<int> lowLink(functions.size(), 0);
+    std::vector<bool> onStack(functions.size(), false);
+    std::vector<unsigned> stack;
+    int counter = 0;
+    functionComponents.assign(functions.size(), 0);
+    components.clear();
+    std::function<void(unsigned)> visit = [&](unsigned index) {
+        visitOrder[index] = lowLink[index] = counter++;
+        stack.push_back(index);
+        onStack[index] = true;
+        for (unsigned callee : callees[index]) {
+            if (visitOrder[callee] < 0) {
+                visit(callee);
+                lowLink[index] = std::min(lowLink[index], lowLink[callee]);
+            }
+            else if (onStack[callee]) {
+                lowLink[index] = std::min(lowLink[index], visitOrder[callee]);
+            }
+        }
+        if (lowLink[index] != visitOrder[index]) {
+            return;
+        }
+        std::vector<unsigned> members;
+        unsigned member;
+        do {
+            member = stack.back();
+            stack.pop_back();
+            onStack[member] = false;
+            functionComponents[member] = components.size();
+            members.push_back(member);
+        } while (member != index);
+        components.push_back(members);
+    };
+    for (unsigned index = 0; index < functions.size(); ++index) {
+        if (visitOrder[index] < 0) {
+            visit(index);
+        }
+    }
+}
+
+void FunctionSummaries::buildComponent(unsigned component) {
+    PROFILE_SCOPE("engine", "FunctionSummaries::buildComponent");
+    const std::vector<unsigned>& members = components[component];
+    if (!isRecursive(component)) {
+        unsigned member = members.front();
+        summaries[member] = analyzeFunction(member, std::vector<interval_t>(functions[member]->arg_size(), topInterval()));
+        return;
+    }
+
+    std::vector<int64_t> thresholds = options.thresholds;
+    if (options.harvestThresholds) {
+        for (unsigned member : members) {
+            std::vector<int64_t> harvested = WorklistEngine::harvestThresholds(functions[member]);
+            thresholds.insert(thresholds.end(), harvested.begin(), harvested.end());
+        }
+    }
+    std::sort(thresholds.begin(), thresholds.end());
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+
+    // Every member starts out never returning and only grows from there
+    for (unsigned iteration = 0; ; ++iteration) {
+        bool changed = false;
+        for (unsigned member : members) {
+            summary_t next = analyzeFunction(member, std::vector<interval_t>(functions[member]->arg_size(), topInterval()));
+            summary_t& current = summaries[member];
+            if (!next.returns) {
+                continue;
+            }
+            if (!current.returns) {
+                current = next;
+                changed = true;
+                continue;
+            }
+            interval_t joined = IntervalTracker::joinInterval(current.returnInterval, next.returnInterval);
+            interval_t updated = (iteration < WIDENING_DELAY) ? joined : IntervalTracker::widenInterval(current.returnInterval, joined, thresholds);
+            if (!IntervalTracker::isSameInterval(updated, current.returnInterval)) {
+                current.returnInterval = updated;
+                changed = true;
+            }
+        }
+        if (!changed) {
+            break;
+        }
+    }
+}
+
+bool FunctionSummaries::isRecursive(unsigned component) const {
+    const std::vector<unsigned>& members = components[component];
+    if (members.size() > 1) {
+        return true;
+    }
+    const std::vector<unsigned>& memberCallees = callees[members.front()];
+    return std::find(memberCallees.begin(), memberCallees.end(), members.front()) != memberCallees.end();
+}
+
+bool FunctionSummaries::isNeeded(unsigned component) const {
+    // Roots nobody calls never have their summary asked for
+    const std::vector<unsigned>& members = components[component];
+    return std::any_of(members.begin(), members.end(), [this](unsigned member) { return called[member]; });
+}
+
+FunctionSummaries::summary_t FunctionSummaries::analyzeFunction(unsigned index, const std::vector<interval_t>& arguments) const {
+    Function* F = functions[index];
+    Arena arena;
+    SlotNumbering slots(F);
+    IntervalAnalyzer initialState(std::vector<std::string>(), &slots, &arena);
+    initialState.setCallSummaries(this);
+    unsigned argumentIndex = 0;
+    for (auto& argument : F->args()) {
+        if (argumentIndex < arguments.size()) {
+            initialState.setValueInterval(&argument, arguments[argumentIndex]);
+        }
+        ++argumentIndex;
+    }
+    AnalysisBudget budget(limits);
+    WorklistEngine engine(F, initialState, options, &arena);
+    engine.setBudget(&budget);
+    engine.run(F->getName().str());
+    if (budget.isExhausted()) {
+        std::lock_guard<std::mutex> guard(degradationsLock);
+        degradations.emplace(index, budget.getReason());
+    }
+
+    // Join what every reachable return hands back
+    summary_t summary = {false, topInterval()};
+    for (auto& BB : *F) {
+        ReturnInst* returnInst = dyn_cast<ReturnInst>(BB.getTerminator());
+        const IntervalAnalyzer* state = engine.getExitState(&BB);
+        if ((returnInst == nullptr) || (state == nullptr) || state->isUnreachable()) {
+            continue;
+        }
+        Value* returnValue = returnInst->getReturnValue();
+        interval_t returned = ((returnValue != nullptr) && returnValue->getType()->isIntegerTy()) ? state->getOperandInterval(returnValue) : topInterval();
+        summary.returnInterval = summary.returns ? IntervalTracker::joinInterval(summary.returnInterval, returned) : returned;
+        summary.returns = true;
+    }
+    return summary;
+}
+
+FunctionSummaries::summary_t FunctionSummaries::getSpecialization(unsigned index, const std::vector<interval_t>& arguments) const {
+    // Intervals are plain pairs of integers, so their bytes make the key
+    std::string key(arguments.size() * sizeof(interval_t), '\0');
+    if (!arguments.empty()) {
+        memcpy(&key[0], arguments.data(), key.size());
+    }
+    std::pair<unsigned, std::string> specializationKey = std::make_pair(index, key);
+    {
+        std::lock_guard<std::mutex> guard(specializationsLock);
+        auto found = specializations.find(specializationKey);
+        if (found != specializations.end()) {
+            return found->second;
+        }
+        if (specializationCounts[index] >= SPECIALIZATION_LIMIT) {
+            return summaries[index];
+        }
+    }
+
+    // Analyzed without the lock, two threads may both compute the same entry
+    summary_t specialized = analyzeFunction(index, arguments);
+    std::lock_guard<std::mutex> guard(specializationsLock);
+    if ((specializationCounts[index] < SPECIALIZATION_LIMIT) && specializations.emplace(specializationKey, specialized).second) {
+        ++specializationCounts[index];
+    }
+    return specialized;
+}
\ No newline at end of file
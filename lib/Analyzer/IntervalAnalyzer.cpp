@@ -1,5 +1,8 @@
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <vector>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -7,55 +10,114 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Constants.h"
 #include "../../include/Analyzer/IntervalAnalyzer.h"
+#include "../../include/Analyzer/SeparationTracker.h"
+#include "../../include/Support/Log.h"
+#include "../../include/Support/Profiler.h"
 #include "../../include/Tracker/IntervalTracker.h"
 #include "../../include/Tracker/ValueTracker.h"
+#include "../../include/Tracker/SlotNumbering.h"
 
-IntervalAnalyzer::IntervalAnalyzer(std::string varName) {
-    variableName = varName;
-    interval = std::make_tuple(std::nan("-infinity"), std::nan("+infinity"));
+std::vector<std::string> IntervalAnalyzer::getNamedVariables(const SlotNumbering* slots) {
+    std::vector<std::string> names;
+    for (unsigned slot = 0; slot < slots->size(); ++slot) {
+        const Value* value = slots->getValue(slot);
+        if (isa<AllocaInst>(value) && value->hasName()) {
+            names.push_back(value->getName().str());
+        }
+    }
+    return names;
 }
 
-IntervalAnalyzer::IntervalAnalyzer(const IntervalAnalyzer& intervalAnalyzer) {
-    variableName = intervalAnalyzer.getVariableName();
-    interval = IntervalTracker::interval_t(intervalAnalyzer.getInterval());
-    IntervalTracker::switchLoopState(intervalAnalyzer.IntervalTracker::isInLoop());
-    ValueTracker::var_map_t vTracker = intervalAnalyzer.IntervalTracker::getValueTracker();
-    IntervalTracker::var_map_t iTracker = intervalAnalyzer.IntervalTracker::getIntervalsTracker();
-    IntervalTracker::setTracker(iTracker, vTracker);
+IntervalAnalyzer::IntervalAnalyzer(std::vector<std::string> varNames, const SlotNumbering* slots, Arena* arena) : IntervalTracker(slots, arena) {
+    std::vector<int> varSlots;
+    for (auto& name : varNames) {
+        varSlots.push_back(slots->getSlot(name));
+    }
+    variableNames = std::make_shared<const std::vector<std::string>>(varNames);
+    variableSlots = std::make_shared<const std::vector<int>>(varSlots);
 }
 
-IntervalTracker::interval_t IntervalAnalyzer::processNewInstruction(Instruction* i) {
+IntervalAnalyzer::IntervalAnalyzer(const IntervalAnalyzer& intervalAnalyzer) : IntervalTracker(intervalAnalyzer) {
+    variableNames = intervalAnalyzer.variableNames;
+    variableSlots = intervalAnalyzer.variableSlots;
+    separationTracker = intervalAnalyzer.separationTracker;
+}
+
+void IntervalAnalyzer::processNewInstruction(Instruction* i) {
+    PROFILE_SCOPE("opcode", i->getOpcodeName());
     IntervalTracker::processNewEntry(i);
-    interval = getUpdatedInterval();
-    return interval;
+    separationTracker.processNewEntry(i, *this);
 }
 
 void IntervalAnalyzer::printIntervalReport() {
-    const char* varName = variableName.c_str();
-    double varValue = IntervalTracker::getVariableValue(variableName);
-    IntervalTracker::interval_t variableInterval = getInterval();
-    double min = std::get<0>(variableInterval);
-    double max = std::get<1>(variableInterval);
-    std::string minString = (std::isnan(min)) ? "-infinity" : std::to_string(min);
-    std::string maxString = (std::isnan(max)) ? "+infinity" : std::to_string(max);
-    const char* minText = minString.c_str();
-    const char* maxText = maxString.c_str();
-    printf("Interval of variable %s = [ %s , %s] --- True value = %lf", varName, minText, maxText, varValue);
-    printf("\n");
+    for (unsigned var = 0; var < variableNames->size(); ++var) {
+        const char* varName = (*variableNames)[var].c_str();
+        double varValue = IntervalTracker::getVariableValue((*variableSlots)[var]);
+        IntervalTracker::interval_t variableInterval = IntervalTracker::getVariableInterval((*variableSlots)[var]);
+        std::string minString = Interval::formatBound(variableInterval.lower);
+        std::string maxString = Interval::formatBound(variableInterval.upper);
+        const char* minText = minString.c_str();
+        const char* maxText = maxString.c_str();
+        LOG(LOG_TRACE, "Interval of variable %s = [ %s , %s] --- True value = %lf\n", varName, minText, maxText, varValue);
+    }
 }
 
 void IntervalAnalyzer::printIntervalTracker() {
     IntervalTracker::printTracker();
 }
 
-std::string IntervalAnalyzer::getVariableName() const {
-    return variableName;
+std::vector<std::string> IntervalAnalyzer::getVariableNames() const {
+    return *variableNames;
+}
+
+IntervalAnalyzer::interval_list_t IntervalAnalyzer::getIntervals() const {
+    interval_list_t intervals;
+    for (int slot : *variableSlots) {
+        intervals.push_back(IntervalTracker::getVariableInterval(slot));
+    }
+    return intervals;
 }
 
-IntervalTracker::interval_t IntervalAnalyzer::getInterval() const {
-    return interval;
+void IntervalAnalyzer::addIntervalsToReport(std::string contextName, var_report_t* report) const {
+    report->resize(variableSlots->size());
+    for (unsigned var = 0; var < variableSlots->size(); ++var) {
+        (*report)[var][contextName] = IntervalTracker::getVariableInterval((*variableSlots)[var]);
+    }
 }
 
-IntervalTracker::interval_t IntervalAnalyzer::getUpdatedInterval() {
-    return IntervalTracker::interval_t(IntervalTracker::getVariableInterval(variableName));
+void IntervalAnalyzer::addSeparationsToReport(std::string contextName, const std::vector<SeparationTracker::slot_pair_t>& pairSlots, var_report_t* report) const {
+    // The zone and the intervals each bound the distance, keep the tighter of both
+    report->resize(pairSlots.size());
+    for (unsigned pair = 0; pair < pairSlots.size(); ++pair) {
+        int firstSlot = pairSlots[pair].first, secondSlot = pairSlots[pair].second;
+        interval_t difference = Interval::sub(IntervalTracker::getVariableInterval(firstSlot), IntervalTracker::getVariableInterval(secondSlot));
+        interval_t zoneDifference;
+        if (separationTracker.getDifference(firstSlot, secondSlot, &zoneDifference)) {
+            difference = Interval::make(std::max(difference.lower, zoneDifference.lower), std::min(difference.upper, zoneDifference.upper));
+        }
+        (*report)[pair][contextName] = SeparationTracker::getDistance(difference);
+    }
 }
+
+bool IntervalAnalyzer::joinAnalyzer(const IntervalAnalyzer& other) {
+    bool changed = IntervalTracker::joinTracker(other);
+    return separationTracker.joinTracker(other.separationTracker) || changed;
+}
+
+bool IntervalAnalyzer::widenAnalyzer(const IntervalAnalyzer& other, const std::vector<int64_t>& thresholds) {
+    bool changed = IntervalTracker::widenTracker(other, thresholds);
+    return separationTracker.widenTracker(other.separationTracker) || changed;
+}
+
+bool IntervalAnalyzer::narrowAnalyzer(const IntervalAnalyzer& other) {
+    bool changed = IntervalTracker::narrowTracker(other);
+    return separationTracker.narrowTracker(other.separationTracker) || changed;
+}
+
+bool IntervalAnalyzer::includesAnalyzer(const IntervalAnalyzer& other) const {
+    return IntervalTracker::includesTracker(other) && separationTracker.includesTracker(other.separationTracker);
+}
+
+void IntervalAnalyzer::trackSeparations(std::shared_ptr<const SeparationTracker::packing_t> packing, SeparationTracker::zone_stats_t* stats) {
+    separationTracker = SeparationTracker(packing, stats);
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <vector>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/CFG.h"
+#include "../../include/Analyzer/LoopStructure.h"
+
+#define VISITED UINT_MAX
+
+// A vertex of the order, or the head of a component followed by its body
+typedef struct wto_node {
+    BasicBlock* block;
+    bool head;
+    std::vector<wto_node> body;
+} wto_node_t;
+
+// One step of the depth-first walk: a block being visited, or a component
+// whose body is being built after its head closed a cycle
+typedef struct {
+    BasicBlock* block;
+    bool component;
+    unsigned number;
+    unsigned head;
+    bool loop;
+    unsigned nextSuccessor;
+    std::vector<wto_node_t>* partition;
+    std::vector<wto_node_t> body;
+} wto_frame_t;
+
+// Bourdoncle's recursive construction with an explicit stack, so that long
+// chains of blocks do not run out of native stack. A visit yields the
+// smallest depth-first number reachable from its block through blocks still
+// on the stack, which is the block's own number when it heads a cycle.
+// Partitions are built back to front and reversed once complete.
+static void buildPartition(BasicBlock* entry, std::vector<wto_node_t>* partition) {
+    DenseMap<BasicBlock*, unsigned> depthFirstNumbers;
+    std::vector<BasicBlock*> stack;
+    std::deque<wto_frame_t> frames;
+    unsigned count = 0;
+    unsigned reached = 0;
+    bool returning = false;
+    frames.push_back({entry, false, 0, 0, false, 0, partition, {}});
+
+    while (!frames.empty()) {
+        wto_frame_t& frame = frames.back();
+        const Instruction* terminator = frame.block->getTerminator();
+        unsigned successorCount = (terminator != nullptr) ? terminator->getNumSuccessors() : 0;
+
+        if (frame.component) {
+            if (frame.nextSuccessor < successorCount) {
+                BasicBlock* successor = terminator->getSuccessor(frame.nextSuccessor++);
+                if (depthFirstNumbers.lookup(successor) == 0) {
+                    frames.push_back({successor, false, 0, 0, false, 0, &frame.body, {}});
+                }
+                returning = false;
+                continue;
+            }
+            std::reverse(frame.body.begin(), frame.body.end());
+            frame.partition->push_back({frame.block, true, std::move(frame.body)});
+            reached = frame.head;
+            returning = true;
+            frames.pop_back();
+            continue;
+        }
+
+        if (frame.number == 0) {
+            stack.push_back(frame.block);
+            frame.number = ++count;
+            frame.head = frame.number;
+            depthFirstNumbers[frame.block] = frame.number;
+        }
+        else if (returning && (reached <= frame.head)) {
+            frame.head = reached;
+            frame.loop = true;
+        }
+        returning = false;
+        bool descended = false;
+        while (!descended && (frame.nextSuccessor < successorCount)) {
+            BasicBlock* successor = terminator->getSuccessor(frame.nextSuccessor++);
+            unsigned successorNumber = depthFirstNumbers.lookup(successor);
+            if (successorNumber == 0) {
+                frames.push_back({successor, false, 0, 0, false, 0, frame.partition, {}});
+                descended = true;
+            }
+            else if (successorNumber <= frame.head) {
+                frame.head = successorNumber;
+                frame.loop = true;
+            }
+        }
+        if (descended) {
+            continue;
+        }
+
+        reached = frame.head;
+        returning = true;
+        if (frame.head != frame.number) {
+            frames.pop_back();
+            continue;
+        }
+        depthFirstNumbers[frame.block] = VISITED;
+        BasicBlock* element = stack.back();
+        stack.pop_back();
+        if (!frame.loop) {
+            frame.partition->push_back({frame.block, false, {}});
+            frames.pop_back();
+            continue;
+        }
+        // The rest of the cycle is numbered again when the component is built
+        while (element != frame.block) {
+            depthFirstNumbers[element] = 0;
+            element = stack.back();
+            stack.pop_back();
+        }
+        frame.component = true;
+        frame.nextSuccessor = 0;
+        returning = false;
+    }
+    std::reverse(partition->begin(), partition->end());
+}
+
+static void flattenPartition(const std::vector<wto_node_t>& partition, std::vector<LoopStructure::wto_element_t>* order) {
+    for (auto& node : partition) {
+        unsigned index = order->size();
+        order->push_back({node.block, node.head, index + 1});
+        if (node.head) {
+            flattenPartition(node.body, order);
+            (*order)[index].componentEnd = order->size();
+        }
+    }
+}
+
+std::vector<LoopStructure::wto_element_t> LoopStructure::getWeakTopologicalOrder(Function* function) {
+    std::vector<wto_node_t> partition;
+    buildPartition(&function->getEntryBlock(), &partition);
+
+    std::vector<wto_element_t> order;
+    flattenPartition(partition, &order);
+    return order;
+}
+
+LoopStructure::LoopStructure(Function* function) : dominatorTree(*function), loopInfo(dominatorTree) {
+    // Exits taken from inside the body, such as an early return, leave the
+    // loop running, unless the loop has no other way out
+    for (Loop* loop : loopInfo.getLoopsInPreorder()) {
+        SmallVector<Loop::Edge, 4> exitEdges;
+        loop->getExitEdges(exitEdges);
+        bool conditionExit = false;
+        for (auto& edge : exitEdges) {
+            if ((edge.first == loop->getHeader()) || loop->isLoopLatch(edge.first)) {
+                loopEnds.insert(edge.second);
+                conditionExit = true;
+            }
+        }
+        if (!conditionExit) {
+            for (auto& edge : exitEdges) {
+                loopEnds.insert(edge.second);
+            }
+        }
+    }
+}
+
+bool LoopStructure::isLoopBegin(const BasicBlock* BB) const {
+    return loopInfo.isLoopHeader(BB);
+}
+
+bool LoopStructure::isLoopEnd(const BasicBlock* BB) const {
+    return loopEnds.count(BB) != 0;
+}
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../../include/Analyzer/MappedResultCache.h"
+
+#define CACHE_MAGIC 0x4d565449
+#define CACHE_VERSION 2
+#define LOCK_SUFFIX ".lock"
+
+namespace {
+
+bool keyLess(const MappedResultCache::cache_key_t& a, const MappedResultCache::cache_key_t& b) {
+    if (a.moduleHash != b.moduleHash) {
+        return a.moduleHash < b.moduleHash;
+    }
+    if (a.functionHash != b.functionHash) {
+        return a.functionHash < b.functionHash;
+    }
+    return a.optionsHash < b.optionsHash;
+}
+
+bool keyEqual(const MappedResultCache::cache_key_t& a, const MappedResultCache::cache_key_t& b) {
+    return !keyLess(a, b) && !keyLess(b, a);
+}
+
+void appendBytes(std::string* buffer, const void* data, size_t size) {
+    buffer->append(static_cast<const char*>(data), size);
+}
+
+void appendString(std::string* buffer, const std::string& text) {
+    uint32_t length = text.size();
+    appendBytes(buffer, &length, sizeof(length));
+    buffer->append(text);
+}
+
+void encodeEntry(const ResultCache::entry_t& entry, std::string* buffer) {
+    appendBytes(buffer, &entry.analysisTime, sizeof(entry.analysisTime));
+    appendString(buffer, entry.functionName);
+    uint32_t variableCount = entry.variableNames.size();
+    appendBytes(buffer, &variableCount, sizeof(variableCount));
+    for (unsigned var = 0; var < variableCount; ++var) {
+        appendString(buffer, entry.variableNames[var]);
+        uint32_t contextCount = entry.report[var].size();
+        appendBytes(buffer, &contextCount, sizeof(contextCount));
+        for (auto& context : entry.report[var]) {
+            appendBytes(buffer, &context.second, sizeof(context.second));
+            appendString(buffer, context.first);
+        }
+    }
+}
+
+// Bounds checked reads over one mapped record
+class RecordReader {
+    public:
+        RecordReader(const char* data, size_t size) : cursor(data), end(data + size) {
+        }
+
+        bool readBytes(void* value, size_t size) {
+            if ((size_t) (end - cursor) < size) {
+                return false;
+            }
+            memcpy(value, cursor, size);
+            cursor += size;
+            return true;
+        }
+
+        bool readString(std::string* text) {
+            uint32_t length;
+            if (!readBytes(&length, sizeof(length)) || ((size_t) (end - cursor) < length)) {
+                return false;
+            }
+            text->assign(cursor, length);
+            cursor += length;
+            return true;
+        }
+
+    private:
+        const char* cursor;
+        const char* end;
+};
+
+}
+
+MappedResultCache::MappedResultCache() : mapping(nullptr), mappingSize(0), header(nullptr), index(nullptr) {
+}
+
+MappedResultCache::~MappedResultCache() {
+    close();
+}
+
+bool MappedResultCache::open(const char* path) {
+    close();
+    int descriptor = ::open(path, O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    struct stat status;
+    if ((fstat(descriptor, &status) != 0) || ((size_t) status.st_size < sizeof(header_t))) {
+        ::close(descriptor);
+        return false;
+    }
+    // The mapping stays valid after the descriptor is closed and after a writer renames over the file
+    void* mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+    ::close(descriptor);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    mapping = static_cast<const char*>(mapped);
+    mappingSize = status.st_size;
+
+    header = reinterpret_cast<const header_t*>(mapping);
+    if ((header->magic != CACHE_MAGIC) || (header->version != CACHE_VERSION) ||
+        (header->fileSize != mappingSize) ||
+        (header->entryCount > (mappingSize - sizeof(header_t)) / sizeof(index_entry_t)) ||
+        (header->recordsOffset != sizeof(header_t) + header->entryCount * sizeof(index_entry_t))) {
+        close();
+        return false;
+    }
+    index = reinterpret_cast<const index_entry_t*>(mapping + sizeof(header_t));
+    return true;
+}
+
+bool MappedResultCache::read(const cache_key_t& key, ResultCache::entry_t* entry) const {
+    const index_entry_t* found = find(key);
+    if ((found == nullptr) ||
+        (found->recordOffset > mappingSize - header->recordsOffset) ||
+        (found->recordSize > mappingSize - header->recordsOffset - found->recordOffset)) {
+        return false;
+    }
+
+    RecordReader reader(mapping + header->recordsOffset + found->recordOffset, found->recordSize);
+    ResultCache::entry_t decoded;
+    uint32_t variableCount;
+    if (!reader.readBytes(&decoded.analysisTime, sizeof(decoded.analysisTime)) ||
+        !reader.readString(&decoded.functionName) ||
+        !reader.readBytes(&variableCount, sizeof(variableCount))) {
+        return false;
+    }
+    for (unsigned var = 0; var < variableCount; ++var) {
+        std::string variableName;
+        uint32_t contextCount;
+        if (!reader.readString(&variableName) || !reader.readBytes(&contextCount, sizeof(contextCount))) {
+            return false;
+        }
+        decoded.variableNames.push_back(variableName);
+        decoded.report.push_back(IntervalTracker::var_map_t());
+        for (unsigned context = 0; context < contextCount; ++context) {
+            IntervalTracker::interval_t interval;
+            std::string contextName;
+            if (!reader.readBytes(&interval, sizeof(interval)) || !reader.readString(&contextName)) {
+                return false;
+            }
+            decoded.report.back()[contextName] = interval;
+        }
+    }
+    *entry = decoded;
+    return true;
+}
+
+size_t MappedResultCache::size() const {
+    return (header != nullptr) ? header->entryCount : 0;
+}
+
+bool MappedResultCache::publish(const char* path, const std::vector<update_t>& updates) {
+    // Writers take turns so that no one renames over entries another has just added
+    std::string lockPath = std::string(path) + LOCK_SUFFIX;
+    int lockDescriptor = ::open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if ((lockDescriptor < 0) || (flock(lockDescriptor, LOCK_EX) != 0)) {
+        if (lockDescriptor >= 0) {
+            ::close(lockDescriptor);
+        }
+        return false;
+    }
+
+    // Records of the current file are copied over verbatim unless they are replaced
+    MappedResultCache current;
+    current.open(path);
+    std::vector<index_entry_t> entries;
+    std::string records;
+    for (auto& update : updates) {
+        index_entry_t entry = {update.first, records.size(), 0};
+        encodeEntry(*update.second, &records);
+        entry.recordSize = records.size() - entry.recordOffset;
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const index_entry_t& a, const index_entry_t& b) {
+        return keyLess(a.key, b.key);
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [](const index_entry_t& a, const index_entry_t& b) {
+        return keyEqual(a.key, b.key);
+    }), entries.end());
+    size_t updatedCount = entries.size();
+    for (size_t old = 0; old < current.size(); ++old) {
+        const index_entry_t& entry = current.index[old];
+        auto replaced = std::lower_bound(entries.begin(), entries.begin() + updatedCount, entry, [](const index_entry_t& a, const index_entry_t& b) {
+            return keyLess(a.key, b.key);
+        });
+        if (((replaced != entries.begin() + updatedCount) && keyEqual(replaced->key, entry.key)) ||
+            (entry.recordOffset > current.mappingSize - current.header->recordsOffset) ||
+            (entry.recordSize > current.mappingSize - current.header->recordsOffset - entry.recordOffset)) {
+            continue;
+        }
+        entries.push_back({entry.key, records.size(), entry.recordSize});
+        records.append(current.mapping + current.header->recordsOffset + entry.recordOffset, entry.recordSize);
+    }
+    std::sort(entries.begin(), entries.end(), [](const index_entry_t& a, const index_entry_t& b) {
+        return keyLess(a.key, b.key);
+    });
+
+    header_t header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.entryCount = entries.size();
+    header.recordsOffset = sizeof(header_t) + entries.size() * sizeof(index_entry_t);
+    header.fileSize = header.recordsOffset + records.size();
+    std::string contents;
+    contents.reserve(header.fileSize);
+    appendBytes(&contents, &header, sizeof(header));
+    appendBytes(&contents, entries.data(), entries.size() * sizeof(index_entry_t));
+    contents.append(records);
+
+    // Readers only ever see the old file or the complete new one
+    std::string temporaryPath = std::string(path) + "." + std::to_string(getpid());
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    bool written = false;
+    if (file != nullptr) {
+        written = fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+        written = (fflush(file) == 0) && (fsync(fileno(file)) == 0) && written;
+        written = (fclose(file) == 0) && written;
+    }
+    written = written && (rename(temporaryPath.c_str(), path) == 0);
+    if (!written) {
+        unlink(temporaryPath.c_str());
+    }
+    flock(lockDescriptor, LOCK_UN);
+    ::close(lockDescriptor);
+    return written;
+}
+
+void MappedResultCache::close() {
+    if (mapping != nullptr) {
+        munmap(const_cast<char*>(mapping), mappingSize);
+    }
+    mapping = nullptr;
+    mappingSize = 0;
+    header = nullptr;
+    index = nullptr;
+}
+
+const MappedResultCache::index_entry_t* MappedResultCache::find(const cache_key_t& key) const {
+    if (index == nullptr) {
+        return nullptr;
+    }
+    const index_entry_t* end = index + header->entryCount;
+    const index_entry_t* found = std::lower_bound(index, end, key, [](const index_entry_t& entry, const cache_key_t& key) {
+        return keyLess(entry.key, key);
+    });
+    return ((found != end) && keyEqual(found->key, key)) ? found : nullptr;
+}
\ No newline at end of file
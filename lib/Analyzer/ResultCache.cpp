@@ -0,0 +1,94 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include "../../include/Analyzer/ResultCache.h"
+
+#define CACHE_MAGIC "ITVCACHE"
+#define CACHE_VERSION 2
+
+ResultCache::ResultCache(uint64_t optionsHash) : optionsHash(optionsHash) {
+}
+
+bool ResultCache::load(const char* path) {
+    entries.clear();
+    std::ifstream file(path);
+    std::string line;
+    char magic[16];
+    unsigned version;
+    uint64_t fileOptionsHash;
+    if (!std::getline(file, line) ||
+        (sscanf(line.c_str(), "%15s %u %" SCNx64, magic, &version, &fileOptionsHash) != 3) ||
+        (strcmp(magic, CACHE_MAGIC) != 0) || (version != CACHE_VERSION) || (fileOptionsHash != optionsHash)) {
+        return false;
+    }
+
+    std::unordered_map<uint64_t, entry_t> loaded;
+    while (std::getline(file, line)) {
+        uint64_t functionHash;
+        entry_t entry;
+        unsigned variableCount;
+        int nameOffset;
+        if (sscanf(line.c_str(), "F %" SCNx64 " %lf %u %n", &functionHash, &entry.analysisTime, &variableCount, &nameOffset) != 3) {
+            return false;
+        }
+        entry.functionName = line.substr(nameOffset);
+        for (unsigned var = 0; var < variableCount; ++var) {
+            unsigned contextCount;
+            if (!std::getline(file, line) || (sscanf(line.c_str(), "V %u %n", &contextCount, &nameOffset) != 1)) {
+                return false;
+            }
+            entry.variableNames.push_back(line.substr(nameOffset));
+            entry.report.push_back(IntervalTracker::var_map_t());
+            for (unsigned context = 0; context < contextCount; ++context) {
+                IntervalTracker::interval_t interval;
+                if (!std::getline(file, line) || (sscanf(line.c_str(), "C %" SCNd64 " %" SCNd64 " %n", &interval.lower, &interval.upper, &nameOffset) != 2)) {
+                    return false;
+                }
+                entry.report.back()[line.substr(nameOffset)] = interval;
+            }
+        }
+        loaded[functionHash] = entry;
+    }
+    entries.swap(loaded);
+    return true;
+}
+
+bool ResultCache::save(const char* path) const {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "%s %u %016" PRIx64 "\n", CACHE_MAGIC, CACHE_VERSION, optionsHash);
+    // Entries and contexts are sorted so an unchanged analysis rewrites an identical file
+    std::map<uint64_t, const entry_t*> sortedEntries;
+    for (auto& cached : entries) {
+        sortedEntries[cached.first] = &cached.second;
+    }
+    for (auto& cached : sortedEntries) {
+        const entry_t& entry = *cached.second;
+        fprintf(file, "F %016" PRIx64 " %.6f %zu %s\n", cached.first, entry.analysisTime, entry.variableNames.size(), entry.functionName.c_str());
+        for (unsigned var = 0; var < entry.variableNames.size(); ++var) {
+            fprintf(file, "V %zu %s\n", entry.report[var].size(), entry.variableNames[var].c_str());
+            std::map<std::string, IntervalTracker::interval_t> contexts(entry.report[var].begin(), entry.report[var].end());
+            for (auto& context : contexts) {
+                fprintf(file, "C %" PRId64 " %" PRId64 " %s\n", context.second.lower, context.second.upper, context.first.c_str());
+            }
+        }
+    }
+    return fclose(file) == 0;
+}
+
+const ResultCache::entry_t* ResultCache::lookup(uint64_t functionHash) const {
+    auto cached = entries.find(functionHash);
+    return (cached != entries.end()) ? &cached->second : nullptr;
+}
+
+void ResultCache::store(uint64_t functionHash, const entry_t& entry) {
+    entries[functionHash] = entry;
+}
+
+size_t ResultCache::size() const {
+    return entries.size();
+}
\ No newline at end of file
@@ -1,51 +1,463 @@
-#include <string>
-#include <tuple>
-#include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/Module.h"
-#include "llvm/IR/Function.h"
-#include "llvm/IR/Instructions.h"
-#include "llvm/IR/Instruction.h"
+#include <algorithm>
+#include <numeric>
 #include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
 #include "../../include/Analyzer/SeparationTracker.h"
-#include "../../include/Tracker/ValueTracker.h"
+#include "../../include/Support/Log.h"
+
+#define MAX_CLUSTER_VARIABLES 8
+
+static int64_t negateBound(int64_t bound) {
+    if (Interval::isInfinite(bound)) {
+        return (bound == Interval::MINUS_INFINITY) ? Interval::PLUS_INFINITY : Interval::MINUS_INFINITY;
+    }
+    return -bound;
+}
+
+// The variable a value was loaded from, looking through constant offsets and
+// sign extensions, or NO_SLOT
+static int getSourceVariable(Value* value, const SlotNumbering* slots) {
+    while (true) {
+        if (LoadInst* load = dyn_cast<LoadInst>(value)) {
+            return isa<AllocaInst>(load->getPointerOperand()) ? slots->getSlot(load->getPointerOperand()) : SlotNumbering::NO_SLOT;
+        }
+        if (SExtInst* extension = dyn_cast<SExtInst>(value)) {
+            value = extension->getOperand(0);
+            continue;
+        }
+        BinaryOperator* binaryOperator = dyn_cast<BinaryOperator>(value);
+        if ((binaryOperator == nullptr) || !binaryOperator->hasNoSignedWrap() ||
+            ((binaryOperator->getOpcode() != Instruction::Add) && (binaryOperator->getOpcode() != Instruction::Sub))) {
+            return SlotNumbering::NO_SLOT;
+        }
+        bool constantFirst = isa<ConstantInt>(binaryOperator->getOperand(0)) && (binaryOperator->getOpcode() == Instruction::Add);
+        value = binaryOperator->getOperand(constantFirst ? 1 : 0);
+        if (!isa<ConstantInt>(binaryOperator->getOperand(constantFirst ? 0 : 1))) {
+            return SlotNumbering::NO_SLOT;
+        }
+    }
+}
+
+std::shared_ptr<const SeparationTracker::packing_t> SeparationTracker::packVariables(Function* function, const SlotNumbering* slots, const std::vector<slot_pair_t>& pairs) {
+    // Union-find over slots, only components holding a requested variable are kept
+    std::vector<int> parent(slots->size());
+    std::vector<unsigned> size(slots->size(), 1);
+    std::vector<bool> requested(slots->size(), false);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](int slot) {
+        while (parent[slot] != slot) {
+            parent[slot] = parent[parent[slot]];
+            slot = parent[slot];
+        }
+        return slot;
+    };
+    auto merge = [&](int first, int second) {
+        first = find(first);
+        second = find(second);
+        if ((first == second) || (size[first] + size[second] > MAX_CLUSTER_VARIABLES)) {
+            return false;
+        }
+        parent[second] = first;
+        size[first] += size[second];
+        requested[first] = requested[first] || requested[second];
+        return true;
+    };
+    for (auto& pair : pairs) {
+        requested[find(pair.first)] = true;
+        requested[find(pair.second)] = true;
+        if (!merge(pair.first, pair.second)) {
+            LOG(LOG_WARN, "%s and %s do not fit one cluster, their separation only comes from intervals\n", slots->getSlotName(pair.first).c_str(), slots->getSlotName(pair.second).c_str());
+        }
+    }
+
+    // Variables assigned from each other join the requested clusters while there is room
+    std::vector<slot_pair_t> copies;
+    for (Instruction& I : instructions(function)) {
+        StoreInst* store = dyn_cast<StoreInst>(&I);
+        if ((store == nullptr) || !isa<AllocaInst>(store->getPointerOperand())) {
+            continue;
+        }
+        int destination = slots->getSlot(store->getPointerOperand());
+        int source = getSourceVariable(store->getValueOperand(), slots);
+        if ((destination != SlotNumbering::NO_SLOT) && (source != SlotNumbering::NO_SLOT) && (destination != source)) {
+            copies.push_back(std::make_pair(source, destination));
+        }
+    }
+    bool grown = true;
+    while (grown) {
+        grown = false;
+        for (auto& copy : copies) {
+            if ((requested[find(copy.first)] || requested[find(copy.second)]) && merge(copy.first, copy.second)) {
+                grown = true;
+            }
+        }
+    }
+
+    std::shared_ptr<packing_t> packing = std::make_shared<packing_t>();
+    packing->slots = slots;
+    packing->clusterOf.assign(slots->size(), (int) NO_CLUSTER);
+    packing->rowOf.assign(slots->size(), 0);
+    std::vector<int> rootCluster(slots->size(), (int) NO_CLUSTER);
+    for (unsigned slot = 0; slot < slots->size(); ++slot) {
+        int root = find(slot);
+        if (!requested[root]) {
+            continue;
+        }
+        if (rootCluster[root] == NO_CLUSTER) {
+            rootCluster[root] = packing->clusterSizes.size();
+            packing->clusterSizes.push_back(0);
+        }
+        // Row 0 of every matrix is the constant zero
+        packing->clusterOf[slot] = rootCluster[root];
+        packing->rowOf[slot] = ++packing->clusterSizes[rootCluster[root]];
+    }
+    return packing;
+}
+
+SeparationTracker::interval_t SeparationTracker::getDistance(interval_t difference) {
+    if (difference.lower >= 0) {
+        return difference;
+    }
+    if (difference.upper <= 0) {
+        return Interval::make(negateBound(difference.upper), negateBound(difference.lower));
+    }
+    return Interval::make(0, std::max(negateBound(difference.lower), difference.upper));
+}
+
+SeparationTracker::SeparationTracker() : stats(nullptr) {
+}
+
+SeparationTracker::SeparationTracker(std::shared_ptr<const packing_t> packing, zone_stats_t* stats) : packing(packing), stats(stats) {
+    // Nothing is known yet: no bound off the diagonal
+    for (unsigned cluster = 0; cluster < packing->clusterSizes.size(); ++cluster) {
+        unsigned rows = getRowCount(cluster);
+        matrices.push_back(std::make_shared<matrix_t>(rows * rows));
+        matrix_t& matrix = *matrices.back();
+        for (unsigned cell = 0; cell < matrix.size(); ++cell) {
+            matrix[cell] = (cell % (rows + 1) == 0) ? 0 : Interval::PLUS_INFINITY;
+        }
+    }
+    stats->clusters = packing->clusterSizes.size();
+    stats->largestCluster = packing->clusterSizes.empty() ? 0 : *std::max_element(packing->clusterSizes.begin(), packing->clusterSizes.end());
+}
+
+SeparationTracker::SeparationTracker(const SeparationTracker& other) : packing(other.packing), stats(other.stats), matrices(other.matrices) {
+}
+
+SeparationTracker& SeparationTracker::operator=(const SeparationTracker& other) {
+    packing = other.packing;
+    stats = other.stats;
+    matrices = other.matrices;
+    forms.clear();
+    return *this;
+}
+
+bool SeparationTracker::isTracking() const {
+    return !matrices.empty();
+}
+
+void SeparationTracker::processNewEntry(Instruction* i, const IntervalTracker& intervals) {
+    if (!isTracking()) {
+        return;
+    }
+    switch (i->getOpcode()) {
+        case Instruction::Load:
+        case Instruction::Add:
+        case Instruction::Sub:
+        case Instruction::SExt:
+            trackForm(i);
+            break;
+        case Instruction::Store: {
+            StoreInst* store = cast<StoreInst>(i);
+            if (isa<AllocaInst>(store->getPointerOperand())) {
+                assignVariable(packing->slots->getSlot(store->getPointerOperand()), store->getValueOperand(), intervals);
+            }
+            break;
+        }
+        case Instruction::Call:
+            // A callee that can reach the address of a variable may write anything into it
+            for (int slot : packing->slots->getClobberedSlots(cast<CallInst>(i))) {
+                forgetVariable(slot);
+                forgetForms(slot);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+bool SeparationTracker::getDifference(int firstSlot, int secondSlot, interval_t* difference) const {
+    if (!isTracking() || (firstSlot == SlotNumbering::NO_SLOT) || (secondSlot == SlotNumbering::NO_SLOT) ||
+        (packing->clusterOf[firstSlot] == NO_CLUSTER) || (packing->clusterOf[firstSlot] != packing->clusterOf[secondSlot])) {
+        return false;
+    }
+    unsigned cluster = packing->clusterOf[firstSlot];
+    unsigned rows = getRowCount(cluster);
+    unsigned first = packing->rowOf[firstSlot], second = packing->rowOf[secondSlot];
+    const matrix_t& matrix = *matrices[cluster];
+    *difference = Interval::make(negateBound(matrix[second * rows + first]), matrix[first * rows + second]);
+    return true;
+}
+
+bool SeparationTracker::joinTracker(const SeparationTracker& other) {
+    // The join of two closed matrices is their cell-wise maximum, and closed
+    bool changed = false;
+    for (unsigned cluster = 0; cluster < matrices.size(); ++cluster) {
+        if (matrices[cluster] == other.matrices[cluster]) {
+            continue;
+        }
+        const matrix_t& theirs = *other.matrices[cluster];
+        const matrix_t& mine = *matrices[cluster];
+        for (unsigned cell = 0; cell < mine.size(); ++cell) {
+            if (theirs[cell] > mine[cell]) {
+                getWritableMatrix(cluster)[cell] = theirs[cell];
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+bool SeparationTracker::widenTracker(const SeparationTracker& other) {
+    // Every bound that still grows is dropped, the matrix is not closed again
+    // afterwards so that the iteration is guaranteed to stop
+    bool changed = false;
+    for (unsigned cluster = 0; cluster < matrices.size(); ++cluster) {
+        if (matrices[cluster] == other.matrices[cluster]) {
+            continue;
+        }
+        const matrix_t& theirs = *other.matrices[cluster];
+        const matrix_t& mine = *matrices[cluster];
+        for (unsigned cell = 0; cell < mine.size(); ++cell) {
+            if (theirs[cell] > mine[cell]) {
+                getWritableMatrix(cluster)[cell] = Interval::PLUS_INFINITY;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
 
-SeparationTracker::SeparationTracker(std::string varNameOne, std::string varNameTwo) {
-    variableNames = std::make_tuple(varNameOne, varNameTwo);
-    separation = std::nan("inifinity");
+bool SeparationTracker::narrowTracker(const SeparationTracker& other) {
+    // Only bounds lost to widening come back, after which the matrix is closed
+    // from scratch; narrowing runs a bounded number of times on small clusters
+    bool changed = false;
+    for (unsigned cluster = 0; cluster < matrices.size(); ++cluster) {
+        if (matrices[cluster] == other.matrices[cluster]) {
+            continue;
+        }
+        const matrix_t& theirs = *other.matrices[cluster];
+        const matrix_t& mine = *matrices[cluster];
+        bool clusterChanged = false;
+        for (unsigned cell = 0; cell < mine.size(); ++cell) {
+            if ((mine[cell] == Interval::PLUS_INFINITY) && (theirs[cell] != Interval::PLUS_INFINITY)) {
+                getWritableMatrix(cluster)[cell] = theirs[cell];
+                clusterChanged = true;
+            }
+        }
+        if (clusterChanged) {
+            runFullClosure(cluster);
+            changed = true;
+        }
+    }
+    return changed;
 }
 
-double SeparationTracker::processNewEntry(Instruction* i) {
-    valueTracker.processNewEntry(i);
-    return calculateSeparation();
+bool SeparationTracker::includesTracker(const SeparationTracker& other) const {
+    for (unsigned cluster = 0; cluster < matrices.size(); ++cluster) {
+        if (matrices[cluster] == other.matrices[cluster]) {
+            continue;
+        }
+        const matrix_t& theirs = *other.matrices[cluster];
+        const matrix_t& mine = *matrices[cluster];
+        for (unsigned cell = 0; cell < mine.size(); ++cell) {
+            if (theirs[cell] > mine[cell]) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
-void SeparationTracker::printSeparationReport() {
-    const char * varNameOne = std::get<0>(variableNames).c_str();
-    const char * varNameTwo = std::get<1>(variableNames).c_str();
-    double varOne = valueTracker.getVariableValue(varNameOne);
-    double varTwo = valueTracker.getVariableValue(varNameTwo);
-    printf("Sep between '%s' - %lf and '%s' - %lf = %lf", varNameOne, varOne, varNameTwo, varTwo, separation);
-    printf("\n");
+void SeparationTracker::printSeparationTracker() const {
+    for (unsigned slot = 0; isTracking() && (slot < packing->clusterOf.size()); ++slot) {
+        for (unsigned otherSlot = slot + 1; otherSlot < packing->clusterOf.size(); ++otherSlot) {
+            interval_t difference;
+            if (getDifference(slot, otherSlot, &difference)) {
+                LOG(LOG_TRACE, "%s - %s in [ %s , %s ]\n", packing->slots->getSlotName(slot).c_str(), packing->slots->getSlotName(otherSlot).c_str(),
+                    Interval::formatBound(difference.lower).c_str(), Interval::formatBound(difference.upper).c_str());
+            }
+        }
+    }
 }
 
-void SeparationTracker::printVariableTracker() {
-    valueTracker.printTracker();
+unsigned SeparationTracker::getRowCount(unsigned cluster) const {
+    return packing->clusterSizes[cluster] + 1;
+}
+
+SeparationTracker::matrix_t& SeparationTracker::getWritableMatrix(unsigned cluster) {
+    // Matrices are shared between forked states until one of them writes
+    if (matrices[cluster].use_count() != 1) {
+        matrices[cluster] = std::make_shared<matrix_t>(*matrices[cluster]);
+    }
+    return *matrices[cluster];
+}
+
+void SeparationTracker::trackForm(Instruction* i) {
+    form_t form;
+    if (LoadInst* load = dyn_cast<LoadInst>(i)) {
+        if (!isa<AllocaInst>(load->getPointerOperand())) {
+            return;
+        }
+        int slot = packing->slots->getSlot(load->getPointerOperand());
+        if ((slot == SlotNumbering::NO_SLOT) || (packing->clusterOf[slot] == NO_CLUSTER)) {
+            return;
+        }
+        form = {slot, 0};
+    }
+    else if (isa<SExtInst>(i)) {
+        auto source = forms.find(i->getOperand(0));
+        if (source == forms.end()) {
+            return;
+        }
+        form = source->second;
+    }
+    else {
+        // Only additions that cannot wrap keep the distance to the variable exact
+        BinaryOperator* binaryOperator = cast<BinaryOperator>(i);
+        bool constantFirst = isa<ConstantInt>(i->getOperand(0)) && (i->getOpcode() == Instruction::Add);
+        ConstantInt* constant = dyn_cast<ConstantInt>(i->getOperand(constantFirst ? 0 : 1));
+        auto source = forms.find(i->getOperand(constantFirst ? 1 : 0));
+        if (!binaryOperator->hasNoSignedWrap() || (constant == nullptr) || (source == forms.end())) {
+            return;
+        }
+        int64_t value = IntervalTracker::getConstantInterval(constant).lower;
+        int64_t offset = (i->getOpcode() == Instruction::Add) ? Interval::addBounds(source->second.offset, value, Interval::PLUS_INFINITY)
+                                                              : Interval::subBounds(source->second.offset, value, Interval::PLUS_INFINITY);
+        if (Interval::isInfinite(offset) || Interval::isInfinite(value)) {
+            return;
+        }
+        form = {source->second.slot, offset};
+    }
+    forms[i] = form;
 }
 
-double SeparationTracker::calculateSeparation() {
-    std::string varNameOne = std::get<0>(variableNames);
-    std::string varNameTwo = std::get<1>(variableNames);
-    double varOne = valueTracker.getVariableValue(varNameOne);
-    double varTwo = valueTracker.getVariableValue(varNameTwo);
-    if (std::isnan(varOne) || std::isnan(varTwo)) {
-        separation = std::nan("inifinity");
+void SeparationTracker::assignVariable(int slot, Value* value, const IntervalTracker& intervals) {
+    if ((slot == SlotNumbering::NO_SLOT) || (packing->clusterOf[slot] == NO_CLUSTER)) {
+        return;
+    }
+    unsigned cluster = packing->clusterOf[slot];
+    unsigned row = packing->rowOf[slot];
+    auto form = forms.find(value);
+
+    if ((form != forms.end()) && (form->second.slot == slot)) {
+        // x = x + c moves every bound of x by c and keeps the matrix closed
+        shiftVariable(slot, form->second.offset);
+    }
+    else if ((form != forms.end()) && (packing->clusterOf[form->second.slot] == (int) cluster)) {
+        // x = y + c: x - y <= c and y - x <= -c
+        unsigned source = packing->rowOf[form->second.slot];
+        forgetVariable(slot);
+        addConstraint(cluster, row, source, form->second.offset);
+        addConstraint(cluster, source, row, negateBound(form->second.offset));
     }
     else {
-        separation = (varOne >= varTwo) ? (varOne - varTwo) : (varTwo - varOne);
+        // Anything else only bounds x against zero, by its interval
+        interval_t interval = value->getType()->isIntegerTy() ? intervals.getOperandInterval(value) : Interval::top();
+        forgetVariable(slot);
+        if (interval.upper != Interval::PLUS_INFINITY) {
+            addConstraint(cluster, row, 0, interval.upper);
+        }
+        if (interval.lower != Interval::MINUS_INFINITY) {
+            addConstraint(cluster, 0, row, negateBound(interval.lower));
+        }
+    }
+    // The stored register now holds x itself
+    forgetForms(slot);
+    if (!isa<Constant>(value)) {
+        forms[value] = {slot, 0};
+    }
+}
+
+void SeparationTracker::forgetVariable(int slot) {
+    if ((slot == SlotNumbering::NO_SLOT) || (packing->clusterOf[slot] == NO_CLUSTER)) {
+        return;
+    }
+    unsigned cluster = packing->clusterOf[slot];
+    unsigned rows = getRowCount(cluster);
+    unsigned row = packing->rowOf[slot];
+    matrix_t& matrix = getWritableMatrix(cluster);
+    for (unsigned other = 0; other < rows; ++other) {
+        if (other != row) {
+            matrix[row * rows + other] = Interval::PLUS_INFINITY;
+            matrix[other * rows + row] = Interval::PLUS_INFINITY;
+        }
     }
-    return separation;
 }
 
-double SeparationTracker::getSeparation() {
-    return separation;
+void SeparationTracker::shiftVariable(int slot, int64_t offset) {
+    unsigned cluster = packing->clusterOf[slot];
+    unsigned rows = getRowCount(cluster);
+    unsigned row = packing->rowOf[slot];
+    matrix_t& matrix = getWritableMatrix(cluster);
+    for (unsigned other = 0; other < rows; ++other) {
+        if (other != row) {
+            matrix[row * rows + other] = Interval::addBounds(matrix[row * rows + other], offset, Interval::PLUS_INFINITY);
+            matrix[other * rows + row] = Interval::subBounds(matrix[other * rows + row], offset, Interval::PLUS_INFINITY);
+        }
+    }
+    ++stats->updates;
 }
+
+void SeparationTracker::addConstraint(unsigned cluster, unsigned first, unsigned second, int64_t bound) {
+    // Adds first - second <= bound to a closed matrix and closes it again: a
+    // shorter path can only go through the new edge, so one pass over all
+    // pairs is enough
+    unsigned rows = getRowCount(cluster);
+    ++stats->updates;
+    if (bound >= (*matrices[cluster])[first * rows + second]) {
+        return;
+    }
+    matrix_t& matrix = getWritableMatrix(cluster);
+    for (unsigned from = 0; from < rows; ++from) {
+        int64_t toFirst = matrix[from * rows + first];
+        if (toFirst == Interval::PLUS_INFINITY) {
+            continue;
+        }
+        int64_t throughEdge = Interval::addBounds(toFirst, bound, Interval::PLUS_INFINITY);
+        for (unsigned to = 0; to < rows; ++to) {
+            int64_t path = Interval::addBounds(throughEdge, matrix[second * rows + to], Interval::PLUS_INFINITY);
+            matrix[from * rows + to] = std::min(matrix[from * rows + to], path);
+        }
+    }
+    uint64_t cells = (uint64_t) rows * rows;
+    stats->closureCells += cells;
+    stats->maxClosureCells = std::max(stats->maxClosureCells, cells);
+}
+
+void SeparationTracker::forgetForms(int slot) {
+    // Registers loaded before the assignment no longer hold the variable
+    std::vector<const Value*> stale;
+    for (auto& form : forms) {
+        if (form.second.slot == slot) {
+            stale.push_back(form.first);
+        }
+    }
+    for (const Value* value : stale) {
+        forms.erase(value);
+    }
+}
+
+void SeparationTracker::runFullClosure(unsigned cluster) {
+    unsigned rows = getRowCount(cluster);
+    matrix_t& matrix = getWritableMatrix(cluster);
+    for (unsigned through = 0; through < rows; ++through) {
+        for (unsigned from = 0; from < rows; ++from) {
+            for (unsigned to = 0; to < rows; ++to) {
+                int64_t path = Interval::addBounds(matrix[from * rows + through], matrix[through * rows + to], Interval::PLUS_INFINITY);
+                matrix[from * rows + to] = std::min(matrix[from * rows + to], path);
+            }
+        }
+    }
+}
\ No newline at end of file
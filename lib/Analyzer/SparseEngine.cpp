@@ -0,0 +1,498 @@
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/PromoteMemToReg.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "../../include/Analyzer/LoopStructure.h"
+#include "../../include/Analyzer/SparseEngine.h"
+#include "../../include/Support/Profiler.h"
+
+#define DEPTH_SEPARATOR '/'
+#define SSA_SUFFIX ".ssa"
+#define PROBE_PREFIX "interval.probe.i"
+#define PHI_UPDATE_LIMIT 16
+
+// Cloning and promoting add uses to constants and functions shared by the
+// whole module, so only one function is prepared or released at a time
+static std::mutex preparationLock;
+
+static Function* getProbe(Module* module, Type* type) {
+    std::string name = PROBE_PREFIX + std::to_string(type->getIntegerBitWidth());
+    FunctionType* probeType = FunctionType::get(Type::getVoidTy(module->getContext()), {type}, false);
+    return cast<Function>(module->getOrInsertFunction(name, probeType).getCallee());
+}
+
+static IntervalTracker::interval_t topInterval() {
+    return Interval::top();
+}
+
+SparseEngine::ssa_function_t SparseEngine::prepareFunction(Function* function, const std::vector<std::string>& variableNames) {
+    PROFILE_SCOPE("engine", "SparseEngine::prepareFunction");
+    std::lock_guard<std::mutex> guard(preparationLock);
+    ssa_function_t ssa;
+    ValueToValueMapTy valueMap;
+    ssa.function = CloneFunction(function, valueMap);
+    ssa.function->setLinkage(GlobalValue::PrivateLinkage);
+    ssa.function->setName(function->getName() + SSA_SUFFIX);
+    ssa.variableCount = variableNames.size();
+
+    // Variables are looked up by name the same way slots are
+    std::vector<AllocaInst*> variables(variableNames.size(), nullptr);
+    for (auto &BB: *ssa.function) {
+        for (auto &I: BB) {
+            AllocaInst* allocaInst = dyn_cast<AllocaInst>(&I);
+            if (!allocaInst || !allocaInst->hasName()) {
+                continue;
+            }
+            for (unsigned var = 0; var < variableNames.size(); ++var) {
+                if (!variables[var] && (allocaInst->getName() == variableNames[var])) {
+                    variables[var] = allocaInst;
+                }
+            }
+        }
+    }
+
+    // Read every integer variable right before each exit, promotion then
+    // replaces the load with whatever register reaches that point
+    for (auto &BB: *ssa.function) {
+        Instruction* terminator = BB.getTerminator();
+        if (terminator->getNumSuccessors() != 0) {
+            continue;
+        }
+        std::vector<CallInst*> probes(variables.size(), nullptr);
+        for (unsigned var = 0; var < variables.size(); ++var) {
+            if (!variables[var] || !variables[var]->getAllocatedType()->isIntegerTy()) {
+                continue;
+            }
+            Type* type = variables[var]->getAllocatedType();
+            LoadInst* load = new LoadInst(type, variables[var], variableNames[var] + ".exit", terminator);
+            probes[var] = CallInst::Create(getProbe(ssa.function->getParent(), type), {load}, "", terminator);
+        }
+        ssa.exitBlocks.push_back(&BB);
+        ssa.probes.push_back(probes);
+    }
+
+    // Variables whose address escapes stay in memory and read as unknown
+    std::vector<AllocaInst*> promotable;
+    for (auto &I: ssa.function->getEntryBlock()) {
+        AllocaInst* allocaInst = dyn_cast<AllocaInst>(&I);
+        if (allocaInst && isAllocaPromotable(allocaInst)) {
+            promotable.push_back(allocaInst);
+        }
+    }
+    ssa.promotedVariables = promotable.size();
+    if (!promotable.empty()) {
+        DominatorTree dominatorTree(*ssa.function);
+        PromoteMemToReg(promotable, dominatorTree);
+    }
+    return ssa;
+}
+
+void SparseEngine::releaseFunction(const ssa_function_t& ssa) {
+    std::lock_guard<std::mutex> guard(preparationLock);
+    std::vector<Function*> probes;
+    for (auto& exitProbes : ssa.probes) {
+        for (CallInst* probe : exitProbes) {
+            if (probe && (std::find(probes.begin(), probes.end(), probe->getCalledFunction()) == probes.end())) {
+                probes.push_back(probe->getCalledFunction());
+            }
+        }
+    }
+    ssa.function->eraseFromParent();
+
+    // Probe declarations go away with the last copy that called them
+    for (Function* probe : probes) {
+        if (probe->use_empty()) {
+            probe->eraseFromParent();
+        }
+    }
+}
+
+SparseEngine::SparseEngine(const ssa_function_t& ssa, const WorklistEngine::widening_options_t& options, const CallSummaryProvider* summaries)
+    : ssa(ssa), summaries(summaries), transfer(nullptr, &arena), thresholds(options.thresholds), narrowingPasses(options.narrowingPasses), evaluations(0), budget(nullptr) {
+    if (options.harvestThresholds) {
+        std::vector<int64_t> harvested = WorklistEngine::harvestThresholds(ssa.function);
+        thresholds.insert(thresholds.end(), harvested.begin(), harvested.end());
+    }
+    std::sort(thresholds.begin(), thresholds.end());
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+    computeOrder();
+}
+
+void SparseEngine::setBudget(AnalysisBudget* budget) {
+    this->budget = budget;
+    budget->trackArena(&arena);
+}
+
+IntervalAnalyzer::var_report_t SparseEngine::run(std::string functionContextName) {
+    PROFILE_SCOPE("engine", "SparseEngine::run");
+    values.clear();
+    phiUpdates.clear();
+    widenedPhis.clear();
+    neverReturning.clear();
+    executableEdges.clear();
+    executableBlocks.assign(blockOrder.size(), false);
+    worklist.clear();
+    evaluations = 0;
+
+    // Instructions are picked in reverse post-order of their blocks, so a
+    // value is usually settled before its users are looked at
+    executableBlocks[0] = true;
+    for (auto &I: *blockOrder[0]) {
+        worklist.insert(instructionIndex[&I]);
+    }
+    while (!worklist.empty()) {
+        unsigned index = *worklist.begin();
+        worklist.erase(worklist.begin());
+        visitInstruction(instructionOrder[index]);
+    }
+
+    // Recover the precision widening gave away at loop heads, until a pass
+    // changes nothing
+    for (unsigned pass = 0; (pass < narrowingPasses) && !isDegraded(); ++pass) {
+        if (!runNarrowingPass()) {
+            break;
+        }
+    }
+
+    // Report what every variable holds at the end of every reached exit
+    IntervalAnalyzer::var_report_t intervalEndpointTracker(ssa.variableCount);
+    for (unsigned exit = 0; exit < ssa.exitBlocks.size(); ++exit) {
+        BasicBlock* BB = ssa.exitBlocks[exit];
+        auto index = blockIndex.find(BB);
+        if ((index == blockIndex.end()) || !executableBlocks[index->second] || isBlocked(BB)) {
+            continue;
+        }
+        std::string contextName = functionContextName + DEPTH_SEPARATOR + BB->getName().str();
+        for (unsigned var = 0; var < ssa.variableCount; ++var) {
+            interval_t interval = topInterval();
+            CallInst* probe = ssa.probes[exit][var];
+            if (probe && !getOperandInterval(probe->getArgOperand(0), &interval)) {
+                interval = topInterval();
+            }
+            intervalEndpointTracker[var][contextName] = interval;
+        }
+    }
+    return intervalEndpointTracker;
+}
+
+unsigned SparseEngine::getEvaluations() const {
+    return evaluations;
+}
+
+bool SparseEngine::isDegraded() const {
+    return (budget != nullptr) && budget->isExhausted();
+}
+
+unsigned SparseEngine::getPrunedEdges() const {
+    // Edges out of executable blocks that never became executable themselves
+    unsigned prunedEdges = 0;
+    for (unsigned index = 0; index < blockOrder.size(); ++index) {
+        if (!executableBlocks[index] || isBlocked(blockOrder[index])) {
+            continue;
+        }
+        for (BasicBlock* successor : successors(blockOrder[index])) {
+            prunedEdges += executableEdges.count(std::make_pair(blockOrder[index], successor)) ? 0 : 1;
+        }
+    }
+    return prunedEdges;
+}
+
+void SparseEngine::computeOrder() {
+    // Instructions are picked in weak topological order, so inner loops
+    // settle first, and phis widen only at component heads
+    for (auto& element : LoopStructure::getWeakTopologicalOrder(ssa.function)) {
+        BasicBlock* BB = element.block;
+        blockIndex[BB] = blockOrder.size();
+        blockOrder.push_back(BB);
+        loopHeads.push_back(element.head);
+        for (auto &I: *BB) {
+            instructionIndex[&I] = instructionOrder.size();
+            instructionOrder.push_back(&I);
+        }
+    }
+}
+
+void SparseEngine::markEdgeExecutable(BasicBlock* from, BasicBlock* to) {
+    if (!executableEdges.insert(std::make_pair(from, to)).second) {
+        return;
+    }
+    unsigned index = blockIndex[to];
+    if (!executableBlocks[index]) {
+        // The first edge into a block brings all of its instructions in
+        executableBlocks[index] = true;
+        for (auto &I: *to) {
+            worklist.insert(instructionIndex[&I]);
+        }
+        return;
+    }
+
+    // Later edges only add an incoming value to its phis
+    for (PHINode& phi : to->phis()) {
+        worklist.insert(instructionIndex[&phi]);
+    }
+}
+
+void SparseEngine::visitInstruction(Instruction* I) {
+    ++evaluations;
+    if (budget != nullptr) {
+        budget->chargeVisit();
+    }
+    if (I->isTerminator()) {
+        visitTerminator(I);
+        return;
+    }
+
+    bool wasBlocked = isBlocked(I->getParent());
+    interval_t result;
+    bool reached = evaluate(I, &result, true);
+    if (wasBlocked != isBlocked(I->getParent())) {
+        worklist.insert(instructionIndex[I->getParent()->getTerminator()]);
+    }
+    if (!reached || !I->getType()->isIntegerTy()) {
+        return;
+    }
+
+    auto current = values.find(I);
+    if (current != values.end()) {
+        PHINode* phi = dyn_cast<PHINode>(I);
+        if (phi && isDegraded()) {
+            // Out of budget, every phi jumps straight to the infinities
+            result = IntervalTracker::widenInterval(current->second, IntervalTracker::joinInterval(current->second, result), std::vector<int64_t>());
+        }
+        else if (phi && (loopHeads[blockIndex[phi->getParent()]] || (++phiUpdates[phi] > PHI_UPDATE_LIMIT))) {
+            // Phis at loop heads widen against the joined value to guarantee
+            // termination; other phis only keep changing in irreducible loops
+            result = IntervalTracker::widenInterval(current->second, IntervalTracker::joinInterval(current->second, result), thresholds);
+            widenedPhis.insert(phi);
+        }
+        if (IntervalTracker::isSameInterval(result, current->second)) {
+            return;
+        }
+        current->second = result;
+    }
+    else {
+        values[I] = result;
+    }
+    pushUsers(I);
+}
+
+void SparseEngine::visitTerminator(Instruction* I) {
+    BasicBlock* BB = I->getParent();
+    if (isBlocked(BB)) {
+        return;
+    }
+
+    // Skip the successors that the condition interval rules out
+    if (BranchInst* branchInst = dyn_cast<BranchInst>(I)) {
+        if (branchInst->isConditional()) {
+            interval_t condition;
+            if (!getOperandInterval(branchInst->getCondition(), &condition)) {
+                return;
+            }
+            if (condition.upper != 0) {
+                markEdgeExecutable(BB, branchInst->getSuccessor(0));
+            }
+            if (condition.lower != 1) {
+                markEdgeExecutable(BB, branchInst->getSuccessor(1));
+            }
+            return;
+        }
+    }
+    else if (SwitchInst* switchInst = dyn_cast<SwitchInst>(I)) {
+        interval_t condition;
+        if (!getOperandInterval(switchInst->getCondition(), &condition)) {
+            return;
+        }
+        bool exact = Interval::isConstant(condition);
+        bool matched = false;
+        for (auto caseIt : switchInst->cases()) {
+            IntervalTracker::interval_t caseValue = IntervalTracker::getConstantInterval(caseIt.getCaseValue());
+            if ((caseValue.upper < condition.lower) || (caseValue.lower > condition.upper)) {
+                continue;
+            }
+            matched |= exact;
+            markEdgeExecutable(BB, caseIt.getCaseSuccessor());
+        }
+        if (!matched) {
+            markEdgeExecutable(BB, switchInst->getDefaultDest());
+        }
+        return;
+    }
+    for (BasicBlock* successor : successors(BB)) {
+        markEdgeExecutable(BB, successor);
+    }
+}
+
+bool SparseEngine::runNarrowingPass() {
+    bool changed = false;
+    // Blocks and edges stay executable, values are recomputed in order from
+    // the ones before them without widening
+    for (Instruction* I : instructionOrder) {
+        if (!executableBlocks[blockIndex[I->getParent()]] || I->isTerminator() || !I->getType()->isIntegerTy()) {
+            continue;
+        }
+        ++evaluations;
+        interval_t result;
+        auto current = values.find(I);
+        if ((current == values.end()) || !evaluate(I, &result, false)) {
+            continue;
+        }
+        PHINode* phi = dyn_cast<PHINode>(I);
+        result = (phi && widenedPhis.count(phi)) ? IntervalTracker::narrowInterval(current->second, result) : result;
+        if (!IntervalTracker::isSameInterval(current->second, result)) {
+            current->second = result;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool SparseEngine::evaluate(Instruction* I, interval_t* result, bool trackCalls) {
+    interval_t first;
+    interval_t second;
+    if (!I->getType()->isIntegerTy() && !isa<CallInst>(I)) {
+        *result = topInterval();
+        return true;
+    }
+    if (PHINode* phi = dyn_cast<PHINode>(I)) {
+        // Join the incoming values over the edges that can be taken
+        bool reached = false;
+        for (unsigned incoming = 0; incoming < phi->getNumIncomingValues(); ++incoming) {
+            if (!executableEdges.count(std::make_pair(phi->getIncomingBlock(incoming), phi->getParent())) ||
+                !getOperandInterval(phi->getIncomingValue(incoming), &first)) {
+                continue;
+            }
+            *result = reached ? IntervalTracker::joinInterval(*result, first) : first;
+            reached = true;
+        }
+        return reached;
+    }
+    if (BinaryOperator* binaryOperator = dyn_cast<BinaryOperator>(I)) {
+        if (!getOperandInterval(binaryOperator->getOperand(0), &first) || !getOperandInterval(binaryOperator->getOperand(1), &second)) {
+            return false;
+        }
+        *result = transfer.calculateInterval(binaryOperator->getOpcode(), first, second, binaryOperator->getType()->getIntegerBitWidth());
+        return true;
+    }
+    if (ICmpInst* cmpInst = dyn_cast<ICmpInst>(I)) {
+        if (!getOperandInterval(cmpInst->getOperand(0), &first) || !getOperandInterval(cmpInst->getOperand(1), &second)) {
+            return false;
+        }
+        *result = IntervalTracker::compareInterval(cmpInst->getPredicate(), first, second);
+        return true;
+    }
+    if (CastInst* castInst = dyn_cast<CastInst>(I)) {
+        if (!castInst->getSrcTy()->isIntegerTy() || !castInst->getDestTy()->isIntegerTy()) {
+            *result = topInterval();
+            return true;
+        }
+        if (!getOperandInterval(castInst->getOperand(0), &first)) {
+            return false;
+        }
+        *result = IntervalTracker::castInterval(castInst->getOpcode(), first, castInst->getSrcTy()->getIntegerBitWidth(), castInst->getDestTy()->getIntegerBitWidth());
+        return true;
+    }
+    if (SelectInst* selectInst = dyn_cast<SelectInst>(I)) {
+        interval_t condition;
+        if (!getOperandInterval(selectInst->getCondition(), &condition)) {
+            return false;
+        }
+        bool trueReached = (condition.upper != 0) && getOperandInterval(selectInst->getTrueValue(), &first);
+        bool falseReached = (condition.lower != 1) && getOperandInterval(selectInst->getFalseValue(), &second);
+        if (trueReached && falseReached) {
+            *result = IntervalTracker::joinInterval(first, second);
+        }
+        else {
+            *result = trueReached ? first : second;
+        }
+        return trueReached || falseReached;
+    }
+    if (CallInst* callInst = dyn_cast<CallInst>(I)) {
+        // Without a summary the result is unknown, as for calls to declarations
+        *result = topInterval();
+        Function* callee = callInst->getCalledFunction();
+        if ((summaries == nullptr) || (callee == nullptr) || callee->isDeclaration()) {
+            return true;
+        }
+        std::vector<interval_t> arguments;
+        for (Value* argument : callInst->args()) {
+            if (!argument->getType()->isIntegerTy()) {
+                arguments.push_back(topInterval());
+            }
+            else if (!getOperandInterval(argument, &first)) {
+                return false;
+            }
+            else {
+                arguments.push_back(first);
+            }
+        }
+        bool returns = summaries->getReturnInterval(ssa.function, callee, arguments, result);
+        if (trackCalls) {
+            if (returns) {
+                neverReturning.erase(callInst);
+            }
+            else {
+                neverReturning.insert(callInst);
+            }
+        }
+        return returns;
+    }
+
+    // Loads left after promotion read memory whose address escaped
+    *result = topInterval();
+    return true;
+}
+
+bool SparseEngine::getOperandInterval(Value* operand, interval_t* result) const {
+    if (ConstantInt* numConstant = dyn_cast<ConstantInt>(operand)) {
+        *result = IntervalTracker::getConstantInterval(numConstant);
+        return true;
+    }
+    // Only integer instructions hold a value, one still missing has not been
+    // reached yet
+    if (isa<Instruction>(operand) && operand->getType()->isIntegerTy()) {
+        auto value = values.find(operand);
+        if (value == values.end()) {
+            return false;
+        }
+        *result = value->second;
+        return true;
+    }
+
+    // Arguments, pointers and undefined values can hold anything
+    *result = topInterval();
+    return true;
+}
+
+bool SparseEngine::isBlocked(const BasicBlock* BB) const {
+    if (neverReturning.empty()) {
+        return false;
+    }
+    for (auto &I: *BB) {
+        const CallInst* callInst = dyn_cast<CallInst>(&I);
+        if (callInst && neverReturning.count(callInst)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SparseEngine::pushUsers(Instruction* I) {
+    for (User* user : I->users()) {
+        Instruction* userInst = dyn_cast<Instruction>(user);
+        if (!userInst) {
+            continue;
+        }
+        auto index = instructionIndex.find(userInst);
+        if ((index != instructionIndex.end()) && executableBlocks[blockIndex[userInst->getParent()]]) {
+            worklist.insert(index->second);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "../../include/Analyzer/WorklistEngine.h"
+#include "../../include/Support/Profiler.h"
+
+#define DEPTH_SEPARATOR '/'
+#define DEFAULT_NARROWING_PASSES 2
+
+WorklistEngine::widening_options_t WorklistEngine::getDefaultOptions() {
+    widening_options_t options;
+    options.harvestThresholds = true;
+    options.narrowingPasses = DEFAULT_NARROWING_PASSES;
+    return options;
+}
+
+std::vector<int64_t> WorklistEngine::harvestThresholds(Function* function) {
+    std::vector<int64_t> thresholds;
+    for (auto &BB: *function) {
+        for (auto &I: BB) {
+            ICmpInst* cmpInst = dyn_cast<ICmpInst>(&I);
+            if (!cmpInst) {
+                continue;
+            }
+            for (auto val = cmpInst->value_op_begin(); val != cmpInst->value_op_end(); ++val) {
+                if (ConstantInt* numConstant = dyn_cast<ConstantInt>(*val)) {
+                    // Strict comparisons bound a variable one step before the constant
+                    IntervalTracker::interval_t constant = IntervalTracker::getConstantInterval(numConstant);
+                    if (!Interval::isConstant(constant)) {
+                        continue;
+                    }
+                    thresholds.push_back(Interval::addBounds(constant.lower, -1, Interval::MINUS_INFINITY));
+                    thresholds.push_back(constant.lower);
+                    thresholds.push_back(Interval::addBounds(constant.lower, 1, Interval::PLUS_INFINITY));
+                }
+            }
+        }
+    }
+    return thresholds;
+}
+
+WorklistEngine::WorklistEngine(Function* function, const IntervalAnalyzer& initialState, const widening_options_t& options, Arena* arena)
+    : function(function), arena(arena), initialState(initialState), thresholds(options.thresholds), narrowingPasses(options.narrowingPasses), blockVisits(0), budget(nullptr) {
+    if (options.harvestThresholds) {
+        std::vector<int64_t> harvested = harvestThresholds(function);
+        thresholds.insert(thresholds.end(), harvested.begin(), harvested.end());
+    }
+    std::sort(thresholds.begin(), thresholds.end());
+    thresholds.erase(std::unique(thresholds.begin(), thresholds.end()), thresholds.end());
+    computeBlockOrder();
+}
+
+void WorklistEngine::setBudget(AnalysisBudget* budget) {
+    this->budget = budget;
+    budget->trackArena(arena);
+}
+
+IntervalAnalyzer::var_report_t WorklistEngine::run(std::string functionContextName) {
+    PROFILE_SCOPE("engine", "WorklistEngine::run");
+    inStates.clear();
+    outStates.clear();
+    outEdges.clear();
+    edgeStates.clear();
+    inStates.resize(blockOrder.size());
+    outStates.resize(blockOrder.size());
+    outEdges.resize(blockOrder.size());
+    edgeStates.resize(blockOrder.size());
+    blockIterations.assign(blockOrder.size(), 0);
+    blockVisits = 0;
+
+    // Edges that go backwards in the order end at component heads, so one
+    // pass over the order stabilizes every component on the way
+    pending.assign(blockOrder.size(), false);
+    inStates[0] = arena->make<IntervalAnalyzer>(initialState);
+    pending[0] = true;
+    stabilizeBlocks(0, blockOrder.size());
+
+    // Recover the precision widening gave away at loop heads, until a pass
+    // changes nothing
+    for (unsigned pass = 0; (pass < narrowingPasses) && !isDegraded(); ++pass) {
+        if (!runNarrowingPass()) {
+            break;
+        }
+    }
+
+    // Report the intervals reached at the end of every exit block
+    IntervalAnalyzer::var_report_t intervalEndpointTracker(initialState.getVariableNames().size());
+    for (unsigned index = 0; index < blockOrder.size(); ++index) {
+        if (!isExitBlock(index)) {
+            continue;
+        }
+        std::string contextName = functionContextName + DEPTH_SEPARATOR + blockOrder[index]->getName().str();
+        outStates[index]->addIntervalsToReport(contextName, &intervalEndpointTracker);
+    }
+    return intervalEndpointTracker;
+}
+
+IntervalAnalyzer::var_report_t WorklistEngine::reportSeparations(std::string functionContextName, const std::vector<SeparationTracker::slot_pair_t>& pairSlots) const {
+    // Distances between the requested pairs at the end of every exit block, after run()
+    IntervalAnalyzer::var_report_t separations(pairSlots.size());
+    for (unsigned index = 0; index < blockOrder.size(); ++index) {
+        if (!isExitBlock(index)) {
+            continue;
+        }
+        std::string contextName = functionContextName + DEPTH_SEPARATOR + blockOrder[index]->getName().str();
+        outStates[index]->addSeparationsToReport(contextName, pairSlots, &separations);
+    }
+    return separations;
+}
+
+unsigned WorklistEngine::getBlockVisits() const {
+    return blockVisits;
+}
+
+unsigned WorklistEngine::getPrunedEdges() const {
+    // Edges out of reached blocks that no state of the fixpoint can take
+    unsigned prunedEdges = 0;
+    for (unsigned index = 0; index < outStates.size(); ++index) {
+        if (outStates[index] && !outStates[index]->isUnreachable()) {
+            prunedEdges += blockOrder[index]->getTerminator()->getNumSuccessors() - outEdges[index].size();
+        }
+    }
+    return prunedEdges;
+}
+
+bool WorklistEngine::isDegraded() const {
+    return (budget != nullptr) && budget->isExhausted();
+}
+
+std::vector<WorklistEngine::loop_iterations_t> WorklistEngine::getLoopHeadIterations() const {
+    std::vector<loop_iterations_t> iterations;
+    for (unsigned index = 0; index < blockOrder.size(); ++index) {
+        if (loopHeads[index]) {
+            iterations.push_back(std::make_pair(blockOrder[index], blockIterations[index]));
+        }
+    }
+    return iterations;
+}
+
+const std::vector<int64_t>& WorklistEngine::getThresholds() const {
+    return thresholds;
+}
+
+const IntervalAnalyzer* WorklistEngine::getExitState(const BasicBlock* BB) const {
+    // Blocks the analysis never reached have no state
+    auto index = blockIndex.find(const_cast<BasicBlock*>(BB));
+    if ((index == blockIndex.end()) || (index->second >= outStates.size())) {
+        return nullptr;
+    }
+    return outStates[index->second].get();
+}
+
+void WorklistEngine::computeBlockOrder() {
+    for (auto& element : LoopStructure::getWeakTopologicalOrder(function)) {
+        blockIndex[element.block] = blockOrder.size();
+        blockOrder.push_back(element.block);
+        loopHeads.push_back(element.head);
+        componentEnds.push_back(element.componentEnd);
+    }
+}
+
+void WorklistEngine::stabilizeBlocks(unsigned begin, unsigned end) {
+    for (unsigned index = begin; index < end; ++index) {
+        if (!loopHeads[index]) {
+            if (pending[index]) {
+                visitBlock(index);
+            }
+            continue;
+        }
+        // A component runs again for as long as its head keeps changing,
+        // irreducible loops may also be entered past their head
+        unsigned componentEnd = componentEnds[index];
+        if (std::find(pending.begin() + index, pending.begin() + componentEnd, true) != pending.begin() + componentEnd) {
+            do {
+                if (pending[index]) {
+                    visitBlock(index);
+                }
+                stabilizeBlocks(index + 1, componentEnd);
+            } while (pending[index]);
+        }
+        index = componentEnd - 1;
+    }
+}
+
+void WorklistEngine::visitBlock(unsigned index) {
+    pending[index] = false;
+    if (budget != nullptr) {
+        budget->chargeVisit();
+    }
+    analyzeBlock(index);
+    for (unsigned edge = 0; edge < outEdges[index].size(); ++edge) {
+        unsigned nextIndex = blockIndex[outEdges[index][edge]];
+        if (propagateState(nextIndex, getEdgeState(index, edge))) {
+            pending[nextIndex] = true;
+        }
+    }
+}
+
+bool WorklistEngine::isExitBlock(unsigned index) const {
+    return outStates[index] && !outStates[index]->isUnreachable() && (blockOrder[index]->getTerminator()->getNumSuccessors() == 0);
+}
+
+void WorklistEngine::analyzeBlock(unsigned index) {
+    PROFILE_SCOPE("engine", "WorklistEngine::analyzeBlock");
+    ++blockVisits;
+    ++blockIterations[index];
+
+    BasicBlock* BB = blockOrder[index];
+    Arena::ptr_t<IntervalAnalyzer> state = arena->make<IntervalAnalyzer>(*inStates[index]);
+    PROFILE_BLOCK_VISIT(function->getName().str() + DEPTH_SEPARATOR + BB->getName().str(), state->getBoundedIntervalCount());
+    for (auto &I: *BB) {
+        state->processNewInstruction(&I);
+    }
+    outStates[index] = std::move(state);
+    computeFeasibleEdges(index);
+}
+
+bool WorklistEngine::runNarrowingPass() {
+    bool changed = false;
+    for (unsigned index = 0; index < blockOrder.size(); ++index) {
+        if (!inStates[index]) {
+            continue;
+        }
+
+        // Rebuild the entry state of the block from its predecessors without widening
+        Arena::ptr_t<IntervalAnalyzer> recomputed;
+        if (index == 0) {
+            recomputed = arena->make<IntervalAnalyzer>(initialState);
+        }
+        // A predecessor listed twice adds its edges once
+        std::set<unsigned> predIndices;
+        for (BasicBlock* pred : predecessors(blockOrder[index])) {
+            auto predIndex = blockIndex.find(pred);
+            if ((predIndex != blockIndex.end()) && outStates[predIndex->second]) {
+                predIndices.insert(predIndex->second);
+            }
+        }
+        for (unsigned predIndex : predIndices) {
+            for (unsigned edge = 0; edge < outEdges[predIndex].size(); ++edge) {
+                if (outEdges[predIndex][edge] != blockOrder[index]) {
+                    continue;
+                }
+                if (!recomputed) {
+                    recomputed = arena->make<IntervalAnalyzer>(getEdgeState(predIndex, edge));
+                }
+                else {
+                    recomputed->joinAnalyzer(getEdgeState(predIndex, edge));
+                }
+            }
+        }
+        if (!recomputed) {
+            continue;
+        }
+
+        if (loopHeads[index]) {
+            if (!inStates[index]->narrowAnalyzer(*recomputed)) {
+                continue;
+            }
+        }
+        else if (recomputed->includesAnalyzer(*inStates[index]) && inStates[index]->includesAnalyzer(*recomputed)) {
+            continue;
+        }
+        else {
+            inStates[index] = std::move(recomputed);
+        }
+        changed = true;
+        analyzeBlock(index);
+    }
+    return changed;
+}
+
+void WorklistEngine::computeFeasibleEdges(unsigned index) {
+    outEdges[index].clear();
+    edgeStates[index].clear();
+    const IntervalAnalyzer& state = *outStates[index];
+    if (state.isUnreachable()) {
+        return;
+    }
+    const Instruction *tInst = blockOrder[index]->getTerminator();
+    int branchCount = tInst->getNumSuccessors();
+
+    // Skip the branch that a concrete comparator value rules out
+    double branchComparatorValue = std::nan("undefined");
+    const BranchInst* branchInst = dyn_cast<BranchInst>(tInst);
+    if (branchInst && branchInst->isConditional()) {
+        int branchComparatorSlot = state.getSlotNumbering()->getSlot(branchInst->getCondition());
+        branchComparatorValue = state.getVariableValue(branchComparatorSlot);
+    }
+    for (int i = 0; i < branchCount; ++i) {
+        if (!std::isnan(branchComparatorValue) &&
+            (i == branchComparatorValue)) {
+            continue;
+        }
+        // The operands of the comparison are narrowed to the values that take
+        // this edge, an edge no value can take is pruned
+        Arena::ptr_t<IntervalAnalyzer> edgeState;
+        if (branchInst && branchInst->isConditional()) {
+            edgeState = arena->make<IntervalAnalyzer>(state);
+            if (!edgeState->refineBranch(branchInst, i)) {
+                continue;
+            }
+        }
+        outEdges[index].push_back(tInst->getSuccessor(i));
+        edgeStates[index].push_back(std::move(edgeState));
+    }
+}
+
+const IntervalAnalyzer& WorklistEngine::getEdgeState(unsigned index, unsigned edge) const {
+    return edgeStates[index][edge] ? *edgeStates[index][edge] : *outStates[index];
+}
+
+bool WorklistEngine::propagateState(unsigned successorIndex, const IntervalAnalyzer& state) {
+    Arena::ptr_t<IntervalAnalyzer>& successorState = inStates[successorIndex];
+    if (!successorState) {
+        successorState = arena->make<IntervalAnalyzer>(state);
+        return true;
+    }
+    bool degraded = isDegraded();
+    if (!loopHeads[successorIndex] && !degraded) {
+        return successorState->joinAnalyzer(state);
+    }
+
+    // Loop heads widen against the joined state to guarantee termination,
+    // a state the head already covers would leave it as it is. Out of
+    // budget, every join widens straight to the infinities
+    if (successorState->includesAnalyzer(state)) {
+        return false;
+    }
+    IntervalAnalyzer joinedState(*successorState);
+    joinedState.joinAnalyzer(state);
+    if (degraded) {
+        return successorState->widenAnalyzer(joinedState, std::vector<int64_t>());
+    }
+    return successorState->widenAnalyzer(joinedState, thresholds);
+}
\ No newline at end of file
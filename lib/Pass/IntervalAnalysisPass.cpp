@@ -0,0 +1,62 @@
+#include <map>
+#include <string>
+#include <vector>
+#include "../../include/Pass/IntervalAnalysisPass.h"
+
+AnalysisKey IntervalAnalysis::Key;
+
+IntervalAnalysisResult::IntervalAnalysisResult(Function& F, const WorklistEngine::widening_options_t& options)
+    : arena(new Arena()), slots(new SlotNumbering(&F)) {
+    variableNames = IntervalAnalyzer::getNamedVariables(slots.get());
+    IntervalAnalyzer initialState(variableNames, slots.get(), arena.get());
+    engine.reset(new WorklistEngine(&F, initialState, options, arena.get()));
+    report = engine->run(F.getName().str());
+}
+
+const std::vector<std::string>& IntervalAnalysisResult::getVariableNames() const {
+    return variableNames;
+}
+
+const IntervalAnalyzer::var_report_t& IntervalAnalysisResult::getReport() const {
+    return report;
+}
+
+bool IntervalAnalysisResult::getExitInterval(const BasicBlock* BB, const std::string& variable, IntervalTracker::interval_t* interval) const {
+    const IntervalAnalyzer* state = engine->getExitState(BB);
+    int slot = slots->getSlot(variable);
+    if ((state == nullptr) || state->isUnreachable() || (slot == SlotNumbering::NO_SLOT)) {
+        return false;
+    }
+    *interval = state->getVariableInterval(slot);
+    return true;
+}
+
+void IntervalAnalysisResult::print(raw_ostream& OS) const {
+    for (unsigned var = 0; var < variableNames.size(); ++var) {
+        std::map<std::string, IntervalTracker::interval_t> contexts(report[var].begin(), report[var].end());
+        for (auto& context : contexts) {
+            std::string minString = Interval::formatBound(context.second.lower);
+            std::string maxString = Interval::formatBound(context.second.upper);
+            OS << "  " << variableNames[var] << " at " << context.first << " - [ " << minString << " , " << maxString << " ]\n";
+        }
+    }
+}
+
+IntervalAnalysis::IntervalAnalysis() : options(WorklistEngine::getDefaultOptions()) {
+}
+
+IntervalAnalysis::IntervalAnalysis(const WorklistEngine::widening_options_t& options) : options(options) {
+}
+
+IntervalAnalysis::Result IntervalAnalysis::run(Function& F, FunctionAnalysisManager&) {
+    return IntervalAnalysisResult(F, options);
+}
+
+IntervalPrinterPass::IntervalPrinterPass(raw_ostream& OS) : OS(OS) {
+}
+
+PreservedAnalyses IntervalPrinterPass::run(Function& F, FunctionAnalysisManager& FAM) {
+    OS << "Interval analysis for function '" << F.getName() << "':\n";
+    FAM.getResult<IntervalAnalysis>(F).print(OS);
+    return PreservedAnalyses::all();
+}
\ No newline at end of file
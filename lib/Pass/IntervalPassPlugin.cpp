@@ -0,0 +1,39 @@
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Passes/PassPlugin.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "../../include/Pass/IntervalAnalysisPass.h"
+
+#define PRINTER_PIPELINE_NAME "print<intervals>"
+#define REQUIRE_PIPELINE_NAME "require<intervals>"
+
+// opt -load-pass-plugin=bin/IntervalPlugin.so -passes='print<intervals>' -disable-output <IR file>
+static cl::opt<unsigned> narrowingPasses("interval-narrowing", cl::desc("Narrowing passes run after the interval fixpoint"), cl::init(WorklistEngine::getDefaultOptions().narrowingPasses));
+static cl::opt<bool> harvestThresholds("interval-harvest-thresholds", cl::desc("Widen to the constants of the function's comparisons first"), cl::init(true));
+
+static WorklistEngine::widening_options_t getPluginOptions() {
+    WorklistEngine::widening_options_t options = WorklistEngine::getDefaultOptions();
+    options.narrowingPasses = narrowingPasses;
+    options.harvestThresholds = harvestThresholds;
+    return options;
+}
+
+extern "C" LLVM_ATTRIBUTE_WEAK PassPluginLibraryInfo llvmGetPassPluginInfo() {
+    return {LLVM_PLUGIN_API_VERSION, "IntervalAnalysis", "1.0", [](PassBuilder& PB) {
+        PB.registerAnalysisRegistrationCallback([](FunctionAnalysisManager& FAM) {
+            FAM.registerPass([] { return IntervalAnalysis(getPluginOptions()); });
+        });
+        PB.registerPipelineParsingCallback([](StringRef name, FunctionPassManager& FPM, ArrayRef<PassBuilder::PipelineElement>) {
+            if (name == PRINTER_PIPELINE_NAME) {
+                FPM.addPass(IntervalPrinterPass(outs()));
+                return true;
+            }
+            if (name == REQUIRE_PIPELINE_NAME) {
+                FPM.addPass(RequireAnalysisPass<IntervalAnalysis, Function>());
+                return true;
+            }
+            return false;
+        });
+    }};
+}
\ No newline at end of file
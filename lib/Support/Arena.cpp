@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "../../include/Support/Arena.h"
+
+Arena::Arena(size_t blockSize)
+    : blockSize(blockSize), cursor(nullptr), limit(nullptr), bytesReserved(0), bytesInUse(0), peakBytesInUse(0) {
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    // Free lists are shared by everything of one size, so keep one alignment for all
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    // Freed memory of the same size is reused before bumping the cursor
+    auto freeList = freeLists.find(size);
+    if ((freeList != freeLists.end()) && !freeList->second.empty()) {
+        void* memory = freeList->second.back();
+        freeList->second.pop_back();
+        bytesInUse += size;
+        peakBytesInUse = std::max(peakBytesInUse, bytesInUse);
+        return memory;
+    }
+
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (!cursor || (aligned + size > reinterpret_cast<uintptr_t>(limit))) {
+        // Oversized requests get a block of their own
+        size_t newBlockSize = std::max(blockSize, size + alignment);
+        char* block = static_cast<char*>(::operator new(newBlockSize));
+        blocks.push_back(block);
+        bytesReserved += newBlockSize;
+        cursor = block;
+        limit = block + newBlockSize;
+        aligned = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    cursor = reinterpret_cast<char*>(aligned + size);
+    bytesInUse += size;
+    peakBytesInUse = std::max(peakBytesInUse, bytesInUse);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void Arena::deallocate(void* memory, size_t size) {
+    freeLists[size].push_back(memory);
+    bytesInUse -= size;
+}
+
+void Arena::release() {
+    // Destructors may hand more memory back, so drain the live set one object at a time
+    while (!liveObjects.empty()) {
+        auto object = liveObjects.begin();
+        void* memory = object->first;
+        destructor_t destructor = object->second.first;
+        size_t size = object->second.second;
+        liveObjects.erase(object);
+        destructor(memory);
+        deallocate(memory, size);
+    }
+    for (char* block : blocks) {
+        ::operator delete(block);
+    }
+    blocks.clear();
+    freeLists.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    bytesReserved = 0;
+    bytesInUse = 0;
+}
+
+size_t Arena::getBytesReserved() const {
+    return bytesReserved;
+}
+
+size_t Arena::getPeakBytesInUse() const {
+    return peakBytesInUse;
+}
\ No newline at end of file
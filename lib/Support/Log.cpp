@@ -0,0 +1,43 @@
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include "../../include/Support/Log.h"
+
+static const char* levelNames[] = {"error", "warn", "info", "debug", "trace"};
+
+std::atomic<int> Log::level(LOG_WARN);
+
+int Log::getLevel() {
+    return level.load(std::memory_order_relaxed);
+}
+
+void Log::setLevel(int newLevel) {
+    level.store(newLevel, std::memory_order_relaxed);
+}
+
+bool Log::parseLevel(const char* name, int* parsedLevel) {
+    for (int candidate = LOG_ERROR; candidate <= LOG_TRACE; ++candidate) {
+        if (strcmp(name, levelNames[candidate]) == 0) {
+            *parsedLevel = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Log::write(int messageLevel, const char* format, ...) {
+    // One lock per message keeps lines from different workers whole
+    static std::mutex writeLock;
+    std::lock_guard<std::mutex> guard(writeLock);
+    if (messageLevel == LOG_ERROR) {
+        fputs("error: ", stderr);
+    }
+    else if (messageLevel == LOG_WARN) {
+        fputs("warning: ", stderr);
+    }
+    va_list arguments;
+    va_start(arguments, format);
+    vfprintf(stderr, format, arguments);
+    va_end(arguments);
+}
\ No newline at end of file
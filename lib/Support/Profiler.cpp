@@ -0,0 +1,112 @@
+#ifdef INTERVAL_PROFILING
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+#include "../../include/Support/Profiler.h"
+#include "../../include/Support/StringUtils.h"
+
+Profiler& Profiler::get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::Profiler() : origin(now()) {
+}
+
+Profiler::thread_buffer_t* Profiler::getThreadBuffer() {
+    thread_local thread_buffer_t* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard<std::mutex> guard(buffersLock);
+        buffers.emplace_back(new thread_buffer_t());
+        buffer = buffers.back().get();
+        buffer->threadIndex = buffers.size();
+    }
+    return buffer;
+}
+
+void Profiler::recordSpan(const char* category, const char* name, uint64_t start, uint64_t duration) {
+    getThreadBuffer()->spans.push_back({category, name, start, duration});
+}
+
+void Profiler::recordBlockVisit(const std::string& blockName, unsigned stateSize) {
+    getThreadBuffer()->blockVisits.push_back({blockName, stateSize, now()});
+}
+
+bool Profiler::writeSummary(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Call count and total time per span name, visits and state sizes per block
+    std::map<std::pair<std::string, std::string>, std::pair<uint64_t, uint64_t>> spanTotals;
+    std::map<std::string, std::pair<unsigned, std::pair<uint64_t, unsigned>>> blockTotals;
+    std::lock_guard<std::mutex> guard(buffersLock);
+    for (auto& buffer : buffers) {
+        for (auto& span : buffer->spans) {
+            auto& total = spanTotals[std::make_pair(span.category, span.name)];
+            total.first += 1;
+            total.second += span.duration;
+        }
+        for (auto& visit : buffer->blockVisits) {
+            auto& total = blockTotals[visit.blockName];
+            total.first += 1;
+            total.second.first += visit.stateSize;
+            total.second.second = std::max(total.second.second, visit.stateSize);
+        }
+    }
+
+    fprintf(file, "{\n  \"spans\": [");
+    bool first = true;
+    for (auto& total : spanTotals) {
+        fprintf(file, "%s\n    {\"category\": \"%s\", \"name\": \"%s\", \"calls\": %llu, \"total_ns\": %llu, \"mean_ns\": %.1f}", first ? "" : ",",
+                StringUtils::escapeJson(total.first.first).c_str(), StringUtils::escapeJson(total.first.second).c_str(), (unsigned long long) total.second.first, (unsigned long long) total.second.second,
+                (double) total.second.second / total.second.first);
+        first = false;
+    }
+    fprintf(file, "\n  ],\n  \"blocks\": [");
+    first = true;
+    for (auto& total : blockTotals) {
+        fprintf(file, "%s\n    {\"block\": \"%s\", \"visits\": %u, \"mean_state_size\": %.1f, \"max_state_size\": %u}", first ? "" : ",",
+                StringUtils::escapeJson(total.first).c_str(), total.second.first, (double) total.second.second.first / total.second.first, total.second.second.second);
+        first = false;
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+bool Profiler::writeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // Chrome trace_event format: complete events for spans, instant events for block visits
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+    bool first = true;
+    std::lock_guard<std::mutex> guard(buffersLock);
+    for (auto& buffer : buffers) {
+        for (auto& span : buffer->spans) {
+            fprintf(file, "%s\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}", first ? "" : ",",
+                    StringUtils::escapeJson(span.name).c_str(), StringUtils::escapeJson(span.category).c_str(), (span.start - origin) / 1000.0, span.duration / 1000.0, buffer->threadIndex);
+            first = false;
+        }
+        for (auto& visit : buffer->blockVisits) {
+            fprintf(file, "%s\n{\"name\": \"%s\", \"cat\": \"block\", \"ph\": \"i\", \"s\": \"t\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u, \"args\": {\"state_size\": %u}}", first ? "" : ",",
+                    StringUtils::escapeJson(visit.blockName).c_str(), (visit.time - origin) / 1000.0, buffer->threadIndex, visit.stateSize);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include "../../include/Support/ReportWriter.h"
+#include "../../include/Support/StringUtils.h"
+
+#define REPORT_VERSION 2
+#define BINARY_MAGIC "ITVR"
+#define JSON_FORMAT_NAME "json"
+#define BINARY_FORMAT_NAME "binary"
+#define LOWER_INFINITE 1
+#define UPPER_INFINITE 2
+
+bool ReportWriter::parseFormat(const char* name, Format* format) {
+    if (strcmp(name, JSON_FORMAT_NAME) == 0) {
+        *format = JSON;
+        return true;
+    }
+    if (strcmp(name, BINARY_FORMAT_NAME) == 0) {
+        *format = BINARY;
+        return true;
+    }
+    return false;
+}
+
+ReportWriter::ReportWriter(Format format) : format(format), recordCount(0) {
+}
+
+void ReportWriter::addInterval(const std::string& file, const std::string& function, const std::string& variable, const std::string& context, Interval::interval_t interval) {
+    if (format == JSON) {
+        records += (recordCount == 0) ? "\n" : ",\n";
+        records += "  {\"file\": ";
+        appendJsonString(file);
+        records += ", \"function\": ";
+        appendJsonString(function);
+        records += ", \"variable\": ";
+        appendJsonString(variable);
+        records += ", \"context\": ";
+        appendJsonString(context);
+        records += ", \"lower\": ";
+        appendJsonBound(interval.lower, "\"-inf\"");
+        records += ", \"upper\": ";
+        appendJsonBound(interval.upper, "\"+inf\"");
+        records += "}";
+    }
+    else {
+        appendInteger(&records, internString(file), 4);
+        appendInteger(&records, internString(function), 4);
+        appendInteger(&records, internString(variable), 4);
+        appendInteger(&records, internString(context), 4);
+        // The sentinel values behind the infinities never reach the file
+        unsigned flags = (Interval::isInfinite(interval.lower) ? LOWER_INFINITE : 0) | (Interval::isInfinite(interval.upper) ? UPPER_INFINITE : 0);
+        appendInteger(&records, flags, 1);
+        for (int64_t bound : {interval.lower, interval.upper}) {
+            appendInteger(&records, Interval::isInfinite(bound) ? 0 : (uint64_t) bound, 8);
+        }
+    }
+    ++recordCount;
+}
+
+bool ReportWriter::write(FILE* stream) {
+    std::string output;
+    if (format == JSON) {
+        output = "{\"version\": " + std::to_string(REPORT_VERSION) + ", \"intervals\": [" + records + ((recordCount == 0) ? "]}\n" : "\n]}\n");
+    }
+    else {
+        output.reserve(records.size() + 64);
+        output += BINARY_MAGIC;
+        appendInteger(&output, REPORT_VERSION, 4);
+        appendInteger(&output, strings.size(), 4);
+        for (const std::string* text : strings) {
+            appendInteger(&output, text->size(), 4);
+            output += *text;
+        }
+        appendInteger(&output, recordCount, 4);
+        output += records;
+    }
+    return (fwrite(output.data(), 1, output.size(), stream) == output.size()) && (fflush(stream) == 0);
+}
+
+unsigned ReportWriter::getRecordCount() const {
+    return recordCount;
+}
+
+uint32_t ReportWriter::internString(const std::string& text) {
+    auto inserted = stringIndices.insert(std::make_pair(text, (uint32_t) strings.size()));
+    if (inserted.second) {
+        strings.push_back(&inserted.first->first);
+    }
+    return inserted.first->second;
+}
+
+void ReportWriter::appendJsonString(const std::string& text) {
+    records += '"' + StringUtils::escapeJson(text) + '"';
+}
+
+void ReportWriter::appendJsonBound(int64_t bound, const char* infinity) {
+    if (Interval::isInfinite(bound)) {
+        records += infinity;
+        return;
+    }
+    char number[32];
+    snprintf(number, sizeof(number), "%" PRId64, bound);
+    records += number;
+}
+
+void ReportWriter::appendInteger(std::string* buffer, uint64_t value, unsigned bytes) {
+    for (unsigned byte = 0; byte < bytes; ++byte) {
+        buffer->push_back((char) ((value >> (8 * byte)) & 0xff));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include "../../include/Support/StateKernels.h"
+#include "../../include/Tracker/Interval.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STATE_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// Scalar kernels, also the tail of every vector kernel
+
+static void widenBounds(int64_t* lower, int64_t* upper, int64_t nextLower, int64_t nextUpper, const int64_t* thresholds, size_t thresholdCount) {
+    const int64_t* thresholdsEnd = thresholds + thresholdCount;
+    if (nextLower < *lower) {
+        const int64_t* threshold = std::upper_bound(thresholds, thresholdsEnd, nextLower);
+        *lower = (threshold != thresholds) ? *(threshold - 1) : Interval::MINUS_INFINITY;
+    }
+    if (nextUpper > *upper) {
+        const int64_t* threshold = std::lower_bound(thresholds, thresholdsEnd, nextUpper);
+        *upper = (threshold != thresholdsEnd) ? *threshold : Interval::PLUS_INFINITY;
+    }
+}
+
+static bool joinScalar(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        changed |= (otherLower[i] < lower[i]) | (otherUpper[i] > upper[i]);
+        lower[i] = std::min(lower[i], otherLower[i]);
+        upper[i] = std::max(upper[i], otherUpper[i]);
+    }
+    return changed;
+}
+
+static bool meetScalar(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        changed |= (otherLower[i] > lower[i]) | (otherUpper[i] < upper[i]);
+        lower[i] = std::max(lower[i], otherLower[i]);
+        upper[i] = std::min(upper[i], otherUpper[i]);
+    }
+    return changed;
+}
+
+static bool widenScalar(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count,
+                        const int64_t* thresholds, size_t thresholdCount) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        // A growing bound always moves, the threshold it lands on lies beyond it
+        if ((otherLower[i] < lower[i]) | (otherUpper[i] > upper[i])) {
+            widenBounds(&lower[i], &upper[i], otherLower[i], otherUpper[i], thresholds, thresholdCount);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+static bool narrowScalar(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    bool changed = false;
+    for (size_t i = 0; i < count; ++i) {
+        // Only bounds lost to widening are allowed to come back down
+        int64_t narrowedLower = (lower[i] == Interval::MINUS_INFINITY) ? otherLower[i] : lower[i];
+        int64_t narrowedUpper = (upper[i] == Interval::PLUS_INFINITY) ? otherUpper[i] : upper[i];
+        changed |= (narrowedLower != lower[i]) | (narrowedUpper != upper[i]);
+        lower[i] = narrowedLower;
+        upper[i] = narrowedUpper;
+    }
+    return changed;
+}
+
+static bool includesScalar(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if ((otherLower[i] < lower[i]) | (otherUpper[i] > upper[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool equalsScalar(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if ((otherLower[i] != lower[i]) | (otherUpper[i] != upper[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const StateKernels::kernels_t scalarKernels = {
+    StateKernels::SCALAR, "scalar", joinScalar, meetScalar, widenScalar, narrowScalar, includesScalar, equalsScalar
+};
+
+#ifdef STATE_KERNELS_X86
+
+// SSE4.2 kernels, two intervals per step. Signed 64-bit comparisons only
+// arrived with SSE4.2, min and max are a compare and a blend.
+
+#define SSE42_TARGET __attribute__((target("sse4.2")))
+#define SSE42_LANES 2
+
+SSE42_TARGET static __m128i loadSse42(const int64_t* bounds) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bounds));
+}
+
+SSE42_TARGET static void storeSse42(int64_t* bounds, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bounds), value);
+}
+
+SSE42_TARGET static bool joinSse42(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    __m128i changed = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i currentLower = loadSse42(lower + i), currentUpper = loadSse42(upper + i);
+        __m128i nextLower = loadSse42(otherLower + i), nextUpper = loadSse42(otherUpper + i);
+        __m128i lowerMoves = _mm_cmpgt_epi64(currentLower, nextLower);
+        __m128i upperMoves = _mm_cmpgt_epi64(nextUpper, currentUpper);
+        storeSse42(lower + i, _mm_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeSse42(upper + i, _mm_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm_or_si128(changed, _mm_or_si128(lowerMoves, upperMoves));
+    }
+    bool tailChanged = joinScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm_testz_si128(changed, changed) | tailChanged;
+}
+
+SSE42_TARGET static bool meetSse42(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    __m128i changed = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i currentLower = loadSse42(lower + i), currentUpper = loadSse42(upper + i);
+        __m128i nextLower = loadSse42(otherLower + i), nextUpper = loadSse42(otherUpper + i);
+        __m128i lowerMoves = _mm_cmpgt_epi64(nextLower, currentLower);
+        __m128i upperMoves = _mm_cmpgt_epi64(currentUpper, nextUpper);
+        storeSse42(lower + i, _mm_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeSse42(upper + i, _mm_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm_or_si128(changed, _mm_or_si128(lowerMoves, upperMoves));
+    }
+    bool tailChanged = meetScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm_testz_si128(changed, changed) | tailChanged;
+}
+
+SSE42_TARGET static bool widenSse42(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count,
+                                    const int64_t* thresholds, size_t thresholdCount) {
+    // Growing bounds are rare once a loop settles, so only they take the
+    // scalar threshold search
+    bool changed = false;
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i grows = _mm_or_si128(_mm_cmpgt_epi64(loadSse42(lower + i), loadSse42(otherLower + i)),
+                                     _mm_cmpgt_epi64(loadSse42(otherUpper + i), loadSse42(upper + i)));
+        if (!_mm_testz_si128(grows, grows)) {
+            changed |= widenScalar(lower + i, upper + i, otherLower + i, otherUpper + i, SSE42_LANES, thresholds, thresholdCount);
+        }
+    }
+    changed |= widenScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i, thresholds, thresholdCount);
+    return changed;
+}
+
+SSE42_TARGET static bool narrowSse42(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    const __m128i minusInfinity = _mm_set1_epi64x(Interval::MINUS_INFINITY);
+    const __m128i plusInfinity = _mm_set1_epi64x(Interval::PLUS_INFINITY);
+    __m128i changed = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i currentLower = loadSse42(lower + i), currentUpper = loadSse42(upper + i);
+        __m128i nextLower = loadSse42(otherLower + i), nextUpper = loadSse42(otherUpper + i);
+        __m128i lowerMoves = _mm_andnot_si128(_mm_cmpeq_epi64(nextLower, currentLower), _mm_cmpeq_epi64(currentLower, minusInfinity));
+        __m128i upperMoves = _mm_andnot_si128(_mm_cmpeq_epi64(nextUpper, currentUpper), _mm_cmpeq_epi64(currentUpper, plusInfinity));
+        storeSse42(lower + i, _mm_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeSse42(upper + i, _mm_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm_or_si128(changed, _mm_or_si128(lowerMoves, upperMoves));
+    }
+    bool tailChanged = narrowScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm_testz_si128(changed, changed) | tailChanged;
+}
+
+SSE42_TARGET static bool includesSse42(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i outside = _mm_or_si128(_mm_cmpgt_epi64(loadSse42(lower + i), loadSse42(otherLower + i)),
+                                       _mm_cmpgt_epi64(loadSse42(otherUpper + i), loadSse42(upper + i)));
+        if (!_mm_testz_si128(outside, outside)) {
+            return false;
+        }
+    }
+    return includesScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+}
+
+SSE42_TARGET static bool equalsSse42(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    size_t i = 0;
+    for (; i + SSE42_LANES <= count; i += SSE42_LANES) {
+        __m128i same = _mm_and_si128(_mm_cmpeq_epi64(loadSse42(lower + i), loadSse42(otherLower + i)),
+                                     _mm_cmpeq_epi64(loadSse42(upper + i), loadSse42(otherUpper + i)));
+        if (_mm_movemask_epi8(same) != 0xFFFF) {
+            return false;
+        }
+    }
+    return equalsScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+}
+
+static const StateKernels::kernels_t sse42Kernels = {
+    StateKernels::SSE42, "sse4.2", joinSse42, meetSse42, widenSse42, narrowSse42, includesSse42, equalsSse42
+};
+
+// AVX2 kernels, the same steps four intervals at a time
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX2_LANES 4
+
+AVX2_TARGET static __m256i loadAvx2(const int64_t* bounds) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bounds));
+}
+
+AVX2_TARGET static void storeAvx2(int64_t* bounds, __m256i value) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bounds), value);
+}
+
+AVX2_TARGET static bool joinAvx2(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i currentLower = loadAvx2(lower + i), currentUpper = loadAvx2(upper + i);
+        __m256i nextLower = loadAvx2(otherLower + i), nextUpper = loadAvx2(otherUpper + i);
+        __m256i lowerMoves = _mm256_cmpgt_epi64(currentLower, nextLower);
+        __m256i upperMoves = _mm256_cmpgt_epi64(nextUpper, currentUpper);
+        storeAvx2(lower + i, _mm256_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeAvx2(upper + i, _mm256_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm256_or_si256(changed, _mm256_or_si256(lowerMoves, upperMoves));
+    }
+    bool tailChanged = joinScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm256_testz_si256(changed, changed) | tailChanged;
+}
+
+AVX2_TARGET static bool meetAvx2(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i currentLower = loadAvx2(lower + i), currentUpper = loadAvx2(upper + i);
+        __m256i nextLower = loadAvx2(otherLower + i), nextUpper = loadAvx2(otherUpper + i);
+        __m256i lowerMoves = _mm256_cmpgt_epi64(nextLower, currentLower);
+        __m256i upperMoves = _mm256_cmpgt_epi64(currentUpper, nextUpper);
+        storeAvx2(lower + i, _mm256_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeAvx2(upper + i, _mm256_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm256_or_si256(changed, _mm256_or_si256(lowerMoves, upperMoves));
+    }
+    bool tailChanged = meetScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm256_testz_si256(changed, changed) | tailChanged;
+}
+
+AVX2_TARGET static bool widenAvx2(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count,
+                                  const int64_t* thresholds, size_t thresholdCount) {
+    bool changed = false;
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i grows = _mm256_or_si256(_mm256_cmpgt_epi64(loadAvx2(lower + i), loadAvx2(otherLower + i)),
+                                        _mm256_cmpgt_epi64(loadAvx2(otherUpper + i), loadAvx2(upper + i)));
+        if (!_mm256_testz_si256(grows, grows)) {
+            changed |= widenScalar(lower + i, upper + i, otherLower + i, otherUpper + i, AVX2_LANES, thresholds, thresholdCount);
+        }
+    }
+    changed |= widenScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i, thresholds, thresholdCount);
+    return changed;
+}
+
+AVX2_TARGET static bool narrowAvx2(int64_t* lower, int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    const __m256i minusInfinity = _mm256_set1_epi64x(Interval::MINUS_INFINITY);
+    const __m256i plusInfinity = _mm256_set1_epi64x(Interval::PLUS_INFINITY);
+    __m256i changed = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i currentLower = loadAvx2(lower + i), currentUpper = loadAvx2(upper + i);
+        __m256i nextLower = loadAvx2(otherLower + i), nextUpper = loadAvx2(otherUpper + i);
+        __m256i lowerMoves = _mm256_andnot_si256(_mm256_cmpeq_epi64(nextLower, currentLower), _mm256_cmpeq_epi64(currentLower, minusInfinity));
+        __m256i upperMoves = _mm256_andnot_si256(_mm256_cmpeq_epi64(nextUpper, currentUpper), _mm256_cmpeq_epi64(currentUpper, plusInfinity));
+        storeAvx2(lower + i, _mm256_blendv_epi8(currentLower, nextLower, lowerMoves));
+        storeAvx2(upper + i, _mm256_blendv_epi8(currentUpper, nextUpper, upperMoves));
+        changed = _mm256_or_si256(changed, _mm256_or_si256(lowerMoves, upperMoves));
+    }
+    bool tailChanged = narrowScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+    return !_mm256_testz_si256(changed, changed) | tailChanged;
+}
+
+AVX2_TARGET static bool includesAvx2(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi64(loadAvx2(lower + i), loadAvx2(otherLower + i)),
+                                          _mm256_cmpgt_epi64(loadAvx2(otherUpper + i), loadAvx2(upper + i)));
+        if (!_mm256_testz_si256(outside, outside)) {
+            return false;
+        }
+    }
+    return includesScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+}
+
+AVX2_TARGET static bool equalsAvx2(const int64_t* lower, const int64_t* upper, const int64_t* otherLower, const int64_t* otherUpper, size_t count) {
+    size_t i = 0;
+    for (; i + AVX2_LANES <= count; i += AVX2_LANES) {
+        __m256i same = _mm256_and_si256(_mm256_cmpeq_epi64(loadAvx2(lower + i), loadAvx2(otherLower + i)),
+                                        _mm256_cmpeq_epi64(loadAvx2(upper + i), loadAvx2(otherUpper + i)));
+        if (_mm256_movemask_epi8(same) != -1) {
+            return false;
+        }
+    }
+    return equalsScalar(lower + i, upper + i, otherLower + i, otherUpper + i, count - i);
+}
+
+static const StateKernels::kernels_t avx2Kernels = {
+    StateKernels::AVX2, "avx2", joinAvx2, meetAvx2, widenAvx2, narrowAvx2, includesAvx2, equalsAvx2
+};
+
+#endif
+
+const StateKernels::kernels_t& StateKernels::get() {
+    static const kernels_t* best = get(AVX2) ? get(AVX2) : (get(SSE42) ? get(SSE42) : get(SCALAR));
+    return *best;
+}
+
+const StateKernels::kernels_t* StateKernels::get(level_t level) {
+#ifdef STATE_KERNELS_X86
+    __builtin_cpu_init();
+    switch (level) {
+        case AVX2:
+            return __builtin_cpu_supports("avx2") ? &avx2Kernels : nullptr;
+        case SSE42:
+            return __builtin_cpu_supports("sse4.2") ? &sse42Kernels : nullptr;
+        default:
+            return &scalarKernels;
+    }
+#else
+    return (level == SCALAR) ? &scalarKernels : nullptr;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../../include/Support/StringUtils.h"
+
+bool StringUtils::parseCount(const char* text, unsigned* count) {
+    if ((*text == '\0') || (strspn(text, "0123456789") != strlen(text))) {
+        return false;
+    }
+    errno = 0;
+    unsigned long value = strtoul(text, nullptr, 10);
+    if ((errno == ERANGE) || (value > UINT_MAX)) {
+        return false;
+    }
+    *count = value;
+    return true;
+}
+
+bool StringUtils::parseDecimal(const char* text, double* value) {
+    // Digits and a decimal point, and strtod has to consume all of them
+    if ((*text == '\0') || (strspn(text, "0123456789.") != strlen(text))) {
+        return false;
+    }
+    char* end = nullptr;
+    errno = 0;
+    double parsed = strtod(text, &end);
+    if ((end == text) || (*end != '\0') || (errno == ERANGE)) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+std::string StringUtils::escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if ((c == '"') || (c == '\\')) {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char) c < 0x20) {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", (unsigned char) c);
+            escaped += code;
+        }
+        else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
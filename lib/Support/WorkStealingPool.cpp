@@ -0,0 +1,102 @@
+#include <utility>
+#include "../../include/Support/WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(unsigned workerCount)
+    : nextQueue(0), stealCount(0), pendingTasks(0), queuedTasks(0), stopping(false) {
+    workerCount = (workerCount == 0) ? 1 : workerCount;
+    for (unsigned i = 0; i < workerCount; ++i) {
+        queues.emplace_back(new worker_queue_t());
+    }
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&WorkStealingPool::runWorker, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> guard(stateLock);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(task_t task) {
+    // Tasks are dealt round-robin, stealing evens out any imbalance later on
+    unsigned queueIndex = nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> guard(queues[queueIndex]->lock);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+    }
+    {
+        // Counted once queued, so a worker that claims it always finds it
+        std::lock_guard<std::mutex> guard(stateLock);
+        ++pendingTasks;
+        ++queuedTasks;
+    }
+    taskAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> guard(stateLock);
+    tasksDone.wait(guard, [this] { return pendingTasks == 0; });
+}
+
+unsigned WorkStealingPool::getWorkerCount() const {
+    return workers.size();
+}
+
+unsigned WorkStealingPool::getStealCount() const {
+    return stealCount;
+}
+
+void WorkStealingPool::runWorker(unsigned workerIndex) {
+    while (true) {
+        {
+            // Claim one queued task before looking for it in the deques
+            std::unique_lock<std::mutex> guard(stateLock);
+            taskAvailable.wait(guard, [this] { return stopping || (queuedTasks > 0); });
+            if (queuedTasks == 0) {
+                return;
+            }
+            --queuedTasks;
+        }
+
+        // The claimed task is queued somewhere, but a scan racing with another
+        // worker's can miss it, so scan until it turns up
+        task_t task;
+        while (!takeTask(workerIndex, &task)) {
+            std::this_thread::yield();
+        }
+        task();
+        std::lock_guard<std::mutex> guard(stateLock);
+        if (--pendingTasks == 0) {
+            tasksDone.notify_all();
+        }
+    }
+}
+
+bool WorkStealingPool::takeTask(unsigned workerIndex, task_t* task) {
+    {
+        worker_queue_t& own = *queues[workerIndex];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            *task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (unsigned offset = 1; offset < queues.size(); ++offset) {
+        worker_queue_t& victim = *queues[(workerIndex + offset) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            *task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            ++stealCount;
+            return true;
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -1,9 +1,10 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <iostream>
 #include <string>
-#include <sstream>
-#include <tuple>
 #include <unordered_map>
+#include <vector>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
@@ -11,52 +12,55 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Constants.h"
 #include "../../include/Tracker/ValueTracker.h"
+#include "../../include/Support/Log.h"
+#include "../../include/Support/Profiler.h"
 #include "../../include/Tracker/IntervalTracker.h"
 
-IntervalTracker::var_t IntervalTracker::getVarEntryFromPtr(void* ptr) {
-    // TODO: Add some error handling if ptr == nullptr
-    return *static_cast<var_t*>(ptr);
+IntervalTracker::IntervalTracker(const SlotNumbering* slots, Arena* arena)
+    : slots(slots), valueTracker(slots, arena), intervalsTracker(slots ? slots->size() : 0, Interval::top(), arena) {
 }
 
-void* IntervalTracker::getPtrFromVariableName(std::string name) {
-    var_it_t variableIterator = intervalsTracker.find(name);
-    if (variableIterator == intervalsTracker.end()) {
-        return nullptr;
-    }
-    std::string varName = variableIterator->first;
-    interval_t varValue = std::make_tuple(std::get<0>(variableIterator->second), std::get<1>(variableIterator->second));
-    var_t variable = std::make_pair(varName, varValue);
-    void* elementPtr = &variable;
-    return elementPtr;
+IntervalTracker::interval_t IntervalTracker::getVariableInterval(int slot) const {
+    return (slot != SlotNumbering::NO_SLOT) ? intervalsTracker[slot] : Interval::top();
 }
 
 IntervalTracker::interval_t IntervalTracker::getVariableInterval(std::string name) const {
-    return (intervalsTracker.find(name) != intervalsTracker.end()) ? intervalsTracker.find(name)->second : std::make_tuple(std::nan("-infinity"), std::nan("+infinity"));
+    return getVariableInterval(slots->getSlot(name));
 }
 
-double IntervalTracker::getVariableValue(std::string name) {
-    return valueTracker.getVariableValue(name);
+double IntervalTracker::getVariableValue(int slot) const {
+    return valueTracker.getVariableValue(slot);
 }
 
-IntervalTracker::var_map_t IntervalTracker::getIntervalsTracker() const {
-    return intervalsTracker;
+double IntervalTracker::getVariableValue(std::string name) const {
+    return valueTracker.getVariableValue(name);
 }
 
-ValueTracker::var_map_t IntervalTracker::getValueTracker() const {
-    return valueTracker.getValueTracker();
+const SlotNumbering* IntervalTracker::getSlotNumbering() const {
+    return slots;
 }
 
-void IntervalTracker::setTracker(ValueTracker::var_map_t tracker) {
-    valueTracker.setTracker(tracker);
+unsigned IntervalTracker::getBoundedIntervalCount() const {
+    unsigned count = 0;
+    for (unsigned slot = 0; slot < intervalsTracker.size(); ++slot) {
+        if (!Interval::isTop(intervalsTracker[slot])) {
+            ++count;
+        }
+    }
+    return count;
 }
 
-void IntervalTracker::setTracker(IntervalTracker::var_map_t tracker) {
-    intervalsTracker = var_map_t(tracker);
+IntervalTracker::var_map_t IntervalTracker::getIntervalsTracker() const {
+    // Name-keyed view of the state, only rebuilt for reports
+    var_map_t tracker;
+    for (unsigned slot = 0; slot < intervalsTracker.size(); ++slot) {
+        tracker[slots->getSlotName(slot)] = intervalsTracker[slot];
+    }
+    return tracker;
 }
 
-void IntervalTracker::setTracker(IntervalTracker::var_map_t iTracker, ValueTracker::var_map_t vTracker) {
-    setTracker(iTracker);
-    setTracker(vTracker);
+ValueTracker::var_map_t IntervalTracker::getValueTracker() const {
+    return valueTracker.getValueTracker();
 }
 
 void IntervalTracker::switchLoopState(bool state) {
@@ -67,245 +71,724 @@ bool IntervalTracker::isInLoop() const {
     return loopState;
 }
 
-void IntervalTracker::printTracker() {
-    for (auto variable = intervalsTracker.begin(); variable != intervalsTracker.end(); ++variable) {
-        printf("Key: %s - [ %lf , %lf ]\n", variable->first.c_str(), std::get<0>(variable->second), std::get<1>(variable->second));
+void IntervalTracker::setCallSummaries(const CallSummaryProvider* summaries) {
+    callSummaries = summaries;
+}
+
+bool IntervalTracker::isUnreachable() const {
+    return unreachable;
+}
+
+void IntervalTracker::setValueInterval(const Value* value, interval_t interval) {
+    int slot = slots->getSlot(value);
+    if (slot == SlotNumbering::NO_SLOT) {
+        return;
+    }
+    intervalsTracker.set(slot, interval);
+    valueTracker.editVariable(slot, Interval::isConstant(interval) ? ValueTracker::toValue(interval.lower) : std::nan("undefined"));
+}
+
+IntervalTracker::interval_t IntervalTracker::joinInterval(interval_t first, interval_t second) {
+    // Infinities are the extreme values, so they need no special case
+    return Interval::make(std::min(first.lower, second.lower), std::max(first.upper, second.upper));
+}
+
+IntervalTracker::interval_t IntervalTracker::widenInterval(interval_t previous, interval_t next, const std::vector<int64_t>& thresholds) {
+    // A bound that is still moving jumps to the nearest threshold beyond it
+    // (thresholds are sorted ascending), or to infinity when there is none.
+    // The scalar kernel keeps that rule in one place for both paths.
+    interval_t result = previous;
+    StateKernels::get(StateKernels::SCALAR)->widen(&result.lower, &result.upper, &next.lower, &next.upper, 1, thresholds.data(), thresholds.size());
+    return result;
+}
+
+IntervalTracker::interval_t IntervalTracker::narrowInterval(interval_t previous, interval_t next) {
+    // Only bounds lost to widening are allowed to come back down
+    int64_t lower = (previous.lower == Interval::MINUS_INFINITY) ? next.lower : previous.lower;
+    int64_t upper = (previous.upper == Interval::PLUS_INFINITY) ? next.upper : previous.upper;
+    return Interval::make(lower, upper);
+}
+
+bool IntervalTracker::isSameInterval(interval_t first, interval_t second) {
+    return Interval::isSame(first, second);
+}
+
+bool IntervalTracker::joinTracker(const IntervalTracker& other) {
+    const StateKernels::kernels_t& kernels = StateKernels::get();
+    bool changed = valueTracker.joinTracker(other.valueTracker);
+    changed |= intervalsTracker.combineLeavesWith(other.intervalsTracker, [&kernels](bound_rows_t& rows, const bound_rows_t& otherRows) {
+        return kernels.join(rows.lower, rows.upper, otherRows.lower, otherRows.upper, bound_rows_t::WIDTH);
+    });
+    return changed;
+}
+
+bool IntervalTracker::widenTracker(const IntervalTracker& other, const std::vector<int64_t>& thresholds) {
+    const StateKernels::kernels_t& kernels = StateKernels::get();
+    bool changed = valueTracker.joinTracker(other.valueTracker);
+    changed |= intervalsTracker.combineLeavesWith(other.intervalsTracker, [&kernels, &thresholds](bound_rows_t& rows, const bound_rows_t& otherRows) {
+        return kernels.widen(rows.lower, rows.upper, otherRows.lower, otherRows.upper, bound_rows_t::WIDTH, thresholds.data(), thresholds.size());
+    });
+    return changed;
+}
+
+bool IntervalTracker::narrowTracker(const IntervalTracker& other) {
+    // Concrete values form a finite lattice, so they simply take the recomputed state
+    const StateKernels::kernels_t& kernels = StateKernels::get();
+    valueTracker = other.valueTracker;
+    return intervalsTracker.combineLeavesWith(other.intervalsTracker, [&kernels](bound_rows_t& rows, const bound_rows_t& otherRows) {
+        return kernels.narrow(rows.lower, rows.upper, otherRows.lower, otherRows.upper, bound_rows_t::WIDTH);
+    });
+}
+
+bool IntervalTracker::includesTracker(const IntervalTracker& other) const {
+    const StateKernels::kernels_t& kernels = StateKernels::get();
+    if (!valueTracker.includesTracker(other.valueTracker)) {
+        return false;
     }
-    printf("\n");
+    return intervalsTracker.testLeavesWith(other.intervalsTracker, [&kernels](const bound_rows_t& rows, const bound_rows_t& otherRows) {
+        return kernels.includes(rows.lower, rows.upper, otherRows.lower, otherRows.upper, bound_rows_t::WIDTH);
+    });
 }
 
-void* IntervalTracker::processNewEntry(Instruction* i) {
-    if (isa<AllocaInst>(i)) {
-        return allocateNewVariable(dyn_cast<AllocaInst>(i));
+void IntervalTracker::printTracker() {
+    for (unsigned slot = 0; slot < intervalsTracker.size(); ++slot) {
+        LOG(LOG_TRACE, "Key: %s - [ %s , %s ]\n", slots->getSlotName(slot).c_str(), Interval::formatBound(intervalsTracker[slot].lower).c_str(), Interval::formatBound(intervalsTracker[slot].upper).c_str());
     }
-    else if (isa<StoreInst>(i)) {
-        return storeValueIntoVariable(dyn_cast<StoreInst>(i));
+    LOG(LOG_TRACE, "\n");
+}
+
+int IntervalTracker::processNewEntry(Instruction* i) {
+    switch (i->getOpcode()) {
+        case Instruction::Alloca:
+            return allocateNewVariable(cast<AllocaInst>(i));
+        case Instruction::Store:
+            return storeValueIntoVariable(cast<StoreInst>(i));
+        case Instruction::Load:
+            return loadVariableIntoRegister(cast<LoadInst>(i));
+        case Instruction::ICmp:
+        case Instruction::FCmp:
+            return compareValues(cast<CmpInst>(i));
+        case Instruction::Trunc:
+        case Instruction::ZExt:
+        case Instruction::SExt:
+            return processCast(cast<CastInst>(i));
+        case Instruction::Select:
+            return processSelect(cast<SelectInst>(i));
+        case Instruction::Call:
+            return processCall(cast<CallInst>(i));
+        default:
+            if (BinaryOperator* binaryOperator = dyn_cast<BinaryOperator>(i)) {
+                return processCalculation(binaryOperator);
+            }
+            return SlotNumbering::NO_SLOT;
     }
-    else if (isa<LoadInst>(i)) {
-        return loadVariableIntoRegister(dyn_cast<LoadInst>(i));
+}
+
+int IntervalTracker::allocateNewVariable(AllocaInst* i) {
+    PROFILE_SCOPE("transfer", "allocateNewVariable");
+    int slot = valueTracker.allocateNewVariable(i);
+    if (slot != SlotNumbering::NO_SLOT) {
+        intervalsTracker.set(slot, Interval::top());
     }
-    else if (isa<CmpInst>(i)) {
-        return compareValues(dyn_cast<CmpInst>(i));
+
+    // Returns index of newly created entry
+    return slot;
+}
+
+int IntervalTracker::storeValueIntoVariable(StoreInst* i) {
+    PROFILE_SCOPE("transfer", "storeValueIntoVariable");
+    valueTracker.storeValueIntoVariable(i);
+    interval_t src = getOperandInterval(i->getOperand(0));
+    int dest = slots->getSlot(i->getOperand(1));
+    if (dest == SlotNumbering::NO_SLOT) {
+        return dest;
     }
-    else if (isa<BinaryOperator>(i)) {
-        return processCalculation(dyn_cast<BinaryOperator>(i));
+
+    if (!isInLoop()) {
+        intervalsTracker.set(dest, src);
     }
     else {
-        return nullptr;
+        // An unbounded variable takes the stored bound, an unbounded source keeps it open
+        interval_t destInterval = intervalsTracker[dest];
+        int64_t resultMin = (src.lower == Interval::MINUS_INFINITY) ? Interval::MINUS_INFINITY : ((destInterval.lower == Interval::MINUS_INFINITY) ? src.lower : std::min(destInterval.lower, src.lower));
+        int64_t resultMax = (src.upper == Interval::PLUS_INFINITY) ? Interval::PLUS_INFINITY : ((destInterval.upper == Interval::PLUS_INFINITY) ? src.upper : std::max(destInterval.upper, src.upper));
+        intervalsTracker.set(dest, Interval::make(resultMin, resultMax));
     }
+
+    // Returns index of recently modified entry
+    return dest;
 }
 
-void* IntervalTracker::allocateNewVariable(AllocaInst* i) {
-    void* variablePtr = valueTracker.allocateNewVariable(i);
-    ValueTracker::var_t variable = ValueTracker::getVariableFromPtr(variablePtr);
-    std::string varName = variable.first;
-    interval_t varValue = std::make_tuple(std::nan("-infinity"), std::nan("infinity"));
-    var_t variableInterval = std::make_pair(varName, varValue);
-    intervalsTracker.insert(variableInterval);
+int IntervalTracker::loadVariableIntoRegister(LoadInst* i) {
+    PROFILE_SCOPE("transfer", "loadVariableIntoRegister");
+    int registerSlot = valueTracker.loadVariableIntoRegister(i);
+    if (registerSlot == SlotNumbering::NO_SLOT) {
+        return registerSlot;
+    }
+    // The register holds whatever range the loaded variable may have, which is
+    // wider than its concrete value once several paths have been merged
+    int variableSlot = slots->getSlot(i->getOperand(0));
+    interval_t variableInterval = (variableSlot == SlotNumbering::NO_SLOT) ? Interval::top() : intervalsTracker[variableSlot];
+    intervalsTracker.set(registerSlot, admitValue(registerSlot, variableInterval));
 
-    // Returns reference to newly created entry
-    return getPtrFromVariableName(varName);
+    // Returns index of recently added register entry
+    return registerSlot;
 }
 
-void* IntervalTracker::storeValueIntoVariable(StoreInst* i) {
-    valueTracker.storeValueIntoVariable(i);
-    interval_t src;
-    if (i->getOperand(0)->hasName()) {
-        var_map_t::const_iterator existingVariable = intervalsTracker.find(i->getOperand(0)->getName().str());
-        src = existingVariable->second;
+int IntervalTracker::compareValues(CmpInst* i) {
+    PROFILE_SCOPE("transfer", "compareValues");
+    int slot = valueTracker.compareValues(i);
+    if (slot != SlotNumbering::NO_SLOT) {
+        interval_t result = Interval::make(0, 1);
+        if (isa<ICmpInst>(i) && i->getOperand(0)->getType()->isIntegerTy()) {
+            result = compareInterval(i->getPredicate(), getOperandInterval(i->getOperand(0)), getOperandInterval(i->getOperand(1)));
+        }
+        intervalsTracker.set(slot, admitValue(slot, result));
     }
-    else {
-        ConstantInt* ci = dyn_cast<ConstantInt>(i->getOperand(0));
-        int constant = ci->getSExtValue();
-        src = std::make_tuple(constant, constant);
+    return slot;
+}
+
+IntervalTracker::interval_t IntervalTracker::admitValue(int slot, interval_t interval) {
+    // A concrete value only narrows the interval it lies in, one outside it
+    // contradicts the sound bounds and is dropped. So is a value a double
+    // may have rounded, the exact bounds are never traded for it
+    double value = valueTracker.getVariableValue(slot);
+    if (std::isnan(value)) {
+        return interval;
     }
-    std::string dest = i->getOperand(1)->getName().str();
+    if (!ValueTracker::isExact(value) || (value < (double) interval.lower) || (value > (double) interval.upper)) {
+        valueTracker.editVariable(slot, std::nan("undefined"));
+        return interval;
+    }
+    return Interval::constant((int64_t) value);
+}
 
-    if (!isInLoop()) {
-        intervalsTracker[dest] = src;
+int IntervalTracker::processCalculation(BinaryOperator* i) {
+    PROFILE_SCOPE("transfer", "processCalculation");
+    valueTracker.processCalculation(i);
+
+    // Returns index of recently modified entry
+    switch (i->getOpcode()) {
+        case Instruction::Add:
+            return calculateArithmetic<&IntervalTracker::addCallback>(i);
+        case Instruction::Sub:
+            return calculateArithmetic<&IntervalTracker::subCallback>(i);
+        case Instruction::Mul:
+            return calculateArithmetic<&IntervalTracker::mulCallback>(i);
+        case Instruction::SDiv:
+            return calculateArithmetic<&IntervalTracker::sdivCallback>(i);
+        case Instruction::UDiv:
+            return calculateArithmetic<&IntervalTracker::udivCallback>(i);
+        case Instruction::SRem:
+            return calculateArithmetic<&IntervalTracker::sremCallback>(i);
+        case Instruction::URem:
+            return calculateArithmetic<&IntervalTracker::uremCallback>(i);
+        case Instruction::Shl:
+            return calculateArithmetic<&IntervalTracker::shlCallback>(i);
+        case Instruction::LShr:
+            return calculateArithmetic<&IntervalTracker::lshrCallback>(i);
+        case Instruction::AShr:
+            return calculateArithmetic<&IntervalTracker::ashrCallback>(i);
+        case Instruction::And:
+            return calculateArithmetic<&IntervalTracker::andCallback>(i);
+        case Instruction::Or:
+            return calculateArithmetic<&IntervalTracker::orCallback>(i);
+        case Instruction::Xor:
+            return calculateArithmetic<&IntervalTracker::xorCallback>(i);
+        default:
+            return calculateArithmetic<&IntervalTracker::unknownCallback>(i);
     }
-    else {
-        interval_t destInterval = intervalsTracker.find(dest)->second;
-        double destMin = std::get<0>(destInterval);
-        double destMax = std::get<1>(destInterval);
-        double srcMin = std::get<0>(src);
-        double srcMax = std::get<1>(src);
-        double resultMin = ((std::isnan(destMin) && std::isnan(srcMin)) || (!std::isnan(destMin) && std::isnan(srcMin))) ? std::nan("-infinity") : ((destMin < srcMin) ? destMin: srcMin);
-        double resultMax = ((std::isnan(destMax) && std::isnan(srcMax)) || (!std::isnan(destMax) && std::isnan(srcMax))) ? std::nan("+infinity") : ((destMax > srcMax) ? destMax: srcMax);
-        intervalsTracker[dest] = std::make_tuple(resultMin, resultMax);
+}
+
+int IntervalTracker::processCast(CastInst* i) {
+    PROFILE_SCOPE("transfer", "processCast");
+    valueTracker.processCast(i);
+    int destSlot = slots->getSlot(i);
+    if (destSlot == SlotNumbering::NO_SLOT) {
+        return destSlot;
     }
 
-    // Returns reference to recently modified entry
-    return getPtrFromVariableName(dest);
+    interval_t src = getOperandInterval(i->getOperand(0));
+    intervalsTracker.set(destSlot, castInterval(i->getOpcode(), src, i->getSrcTy()->getIntegerBitWidth(), i->getDestTy()->getIntegerBitWidth()));
+
+    // Returns index of recently modified entry
+    return destSlot;
+}
+
+IntervalTracker::interval_t IntervalTracker::castInterval(unsigned opcode, interval_t src, unsigned srcBits, unsigned destBits) {
+    bool finite = Interval::isFinite(src);
+    interval_t destInterval = src;
+    switch (opcode) {
+        case Instruction::Trunc: {
+            // i1 values are kept as 0 and 1, wider ones as signed numbers
+            int64_t destMin = Interval::getTypeMin(destBits);
+            int64_t destMax = Interval::getTypeMax(destBits);
+            if (!finite || (src.lower < destMin) || (src.upper > destMax)) {
+                destInterval = Interval::make(destMin, destMax);
+            }
+            break;
+        }
+        case Instruction::ZExt:
+            if (!finite || (src.lower < 0)) {
+                destInterval = Interval::make(0, (srcBits == 1) ? 1 : ((srcBits >= 63) ? Interval::PLUS_INFINITY : (INT64_C(1) << srcBits) - 1));
+            }
+            break;
+        case Instruction::SExt:
+            if (srcBits == 1) {
+                // A set i1 sign-extends to -1
+                destInterval = finite ? Interval::make(-src.upper, -src.lower) : Interval::make(-1, 0);
+            }
+            break;
+        default:
+            break;
+    }
+    return destInterval;
 }
 
-void* IntervalTracker::loadVariableIntoRegister(LoadInst* i) {
-    void* variablePtr = valueTracker.loadVariableIntoRegister(i);
-    ValueTracker::var_t variable = ValueTracker::getVariableFromPtr(variablePtr);
-    std::string registerName = variable.first;
-    interval_t varValue = std::make_tuple(variable.second, variable.second);
-    var_t variableInterval = std::make_pair(registerName, varValue);
-    if (intervalsTracker.find(registerName) == intervalsTracker.end()) {
-        intervalsTracker.insert(variableInterval);
+int IntervalTracker::processSelect(SelectInst* i) {
+    PROFILE_SCOPE("transfer", "processSelect");
+    valueTracker.processSelect(i);
+    int destSlot = slots->getSlot(i);
+    if (destSlot == SlotNumbering::NO_SLOT) {
+        return destSlot;
+    }
+
+    double condition = valueTracker.getOperandValue(i->getCondition());
+    interval_t trueInterval = getOperandInterval(i->getTrueValue());
+    interval_t falseInterval = getOperandInterval(i->getFalseValue());
+    if (std::isnan(condition)) {
+        intervalsTracker.set(destSlot, joinInterval(trueInterval, falseInterval));
     }
     else {
-        intervalsTracker[registerName] = varValue;
+        intervalsTracker.set(destSlot, (condition != 0) ? trueInterval : falseInterval);
     }
 
-    // Returns reference to recently added register entry
-    return getPtrFromVariableName(registerName);
+    // Returns index of recently modified entry
+    return destSlot;
 }
 
-void* IntervalTracker::compareValues(CmpInst* i) {
-    return valueTracker.compareValues(i);
+IntervalTracker::interval_t IntervalTracker::compareInterval(CmpInst::Predicate predicate, interval_t first, interval_t second) {
+    if (CmpInst::isUnsigned(predicate)) {
+        // Non-negative operands order the same signed or unsigned
+        if ((first.lower < 0) || (second.lower < 0)) {
+            return Interval::make(0, 1);
+        }
+        predicate = CmpInst::getSignedPredicate(predicate);
+    }
+    if ((predicate == CmpInst::ICMP_SGT) || (predicate == CmpInst::ICMP_SGE)) {
+        std::swap(first, second);
+        predicate = CmpInst::getSwappedPredicate(predicate);
+    }
+    int result = -1;
+    switch (predicate) {
+        case CmpInst::ICMP_EQ:
+        case CmpInst::ICMP_NE:
+            if (Interval::isConstant(first) && Interval::isSame(first, second)) {
+                result = (predicate == CmpInst::ICMP_EQ) ? 1 : 0;
+            }
+            else if ((first.upper < second.lower) || (second.upper < first.lower)) {
+                result = (predicate == CmpInst::ICMP_EQ) ? 0 : 1;
+            }
+            break;
+        case CmpInst::ICMP_SLT:
+            result = (first.upper < second.lower) ? 1 : ((first.lower >= second.upper) ? 0 : result);
+            break;
+        case CmpInst::ICMP_SLE:
+            result = (first.upper <= second.lower) ? 1 : ((first.lower > second.upper) ? 0 : result);
+            break;
+        default:
+            break;
+    }
+    return (result < 0) ? Interval::make(0, 1) : Interval::constant(result);
 }
 
-void* IntervalTracker::processCalculation(BinaryOperator* i) {
-    valueTracker.processCalculation(i);
+bool IntervalTracker::refineComparison(CmpInst::Predicate predicate, interval_t* first, interval_t* second) {
+    // Narrows both operands to the values for which the comparison holds,
+    // false when there are none
+    if (CmpInst::isUnsigned(predicate)) {
+        if ((first->lower < 0) || (second->lower < 0)) {
+            return true;
+        }
+        predicate = CmpInst::getSignedPredicate(predicate);
+    }
+    if ((predicate == CmpInst::ICMP_SGT) || (predicate == CmpInst::ICMP_SGE)) {
+        std::swap(first, second);
+        predicate = CmpInst::getSwappedPredicate(predicate);
+    }
+    switch (predicate) {
+        case CmpInst::ICMP_EQ: {
+            interval_t both = Interval::make(std::max(first->lower, second->lower), std::min(first->upper, second->upper));
+            *first = both;
+            *second = both;
+            break;
+        }
+        case CmpInst::ICMP_NE:
+            // Only a constant at the edge of the other interval cuts it
+            if (Interval::isConstant(*second) && Interval::isConstant(*first) && (first->lower == second->lower)) {
+                return false;
+            }
+            for (auto pair : {std::make_pair(first, second), std::make_pair(second, first)}) {
+                if (!Interval::isConstant(*pair.second)) {
+                    continue;
+                }
+                if (pair.first->lower == pair.second->lower) {
+                    pair.first->lower = Interval::addBounds(pair.first->lower, 1, Interval::MINUS_INFINITY);
+                }
+                else if (pair.first->upper == pair.second->lower) {
+                    pair.first->upper = Interval::subBounds(pair.first->upper, 1, Interval::PLUS_INFINITY);
+                }
+            }
+            break;
+        case CmpInst::ICMP_SLT:
+            first->upper = std::min(first->upper, Interval::subBounds(second->upper, 1, Interval::PLUS_INFINITY));
+            second->lower = std::max(second->lower, Interval::addBounds(first->lower, 1, Interval::MINUS_INFINITY));
+            break;
+        case CmpInst::ICMP_SLE:
+            first->upper = std::min(first->upper, second->upper);
+            second->lower = std::max(second->lower, first->lower);
+            break;
+        default:
+            break;
+    }
+    return (first->lower <= first->upper) && (second->lower <= second->upper);
+}
 
-    arithmetic_function_t calculation;
-    switch (i->getOpcode()) {
+IntervalTracker::interval_t IntervalTracker::getConstantInterval(const ConstantInt* constant) {
+    // Booleans read as 0 and 1, wider constants keep their sign
+    if (constant->getBitWidth() == 1) {
+        return Interval::constant(constant->getZExtValue());
+    }
+    if (constant->getValue().getMinSignedBits() > 64) {
+        return Interval::top();
+    }
+    return Interval::constant(constant->getSExtValue());
+}
+
+IntervalTracker::interval_t IntervalTracker::calculateInterval(unsigned opcode, interval_t first, interval_t second, unsigned bits) {
+    interval_t result;
+    switch (opcode) {
         case Instruction::Add:
-            calculation = std::bind(&IntervalTracker::addCallback, this, std::placeholders::_1, std::placeholders::_2);
+            result = addCallback(first, second);
+            break;
+        case Instruction::Sub:
+            result = subCallback(first, second);
             break;
         case Instruction::Mul:
-            calculation = std::bind(&IntervalTracker::mulCallback, this, std::placeholders::_1, std::placeholders::_2);
+            result = mulCallback(first, second);
             break;
-        case Instruction::Sub:
-            calculation = std::bind(&IntervalTracker::subCallback, this, std::placeholders::_1, std::placeholders::_2);
+        case Instruction::SDiv:
+            result = sdivCallback(first, second);
+            break;
+        case Instruction::UDiv:
+            result = udivCallback(first, second);
             break;
         case Instruction::SRem:
-            calculation = std::bind(&IntervalTracker::sremCallback, this, std::placeholders::_1, std::placeholders::_2);
+            result = sremCallback(first, second);
+            break;
+        case Instruction::URem:
+            result = uremCallback(first, second);
+            break;
+        case Instruction::Shl:
+            result = shlCallback(first, second);
+            break;
+        case Instruction::LShr:
+            result = lshrCallback(first, second);
+            break;
+        case Instruction::AShr:
+            result = ashrCallback(first, second);
+            break;
+        case Instruction::And:
+            result = andCallback(first, second);
+            break;
+        case Instruction::Or:
+            result = orCallback(first, second);
+            break;
+        case Instruction::Xor:
+            result = xorCallback(first, second);
             break;
         default:
+            result = unknownCallback(first, second);
             break;
     }
-    var_t variable = calculateArithmetic(i, calculation);
+    return Interval::fitToWidth(result, bits);
+}
+
+int IntervalTracker::processCall(CallInst* i) {
+    PROFILE_SCOPE("transfer", "processCall");
+    valueTracker.processCall(i);
+    interval_t top = Interval::top();
+    std::vector<interval_t> arguments;
+    for (int slot : slots->getClobberedSlots(i)) {
+        intervalsTracker.set(slot, top);
+    }
+    for (Value* argument : i->args()) {
+        arguments.push_back(argument->getType()->isIntegerTy() ? getOperandInterval(argument) : top);
+    }
+
+    // Without a summary the result is unknown, as for calls to declarations
+    interval_t result = top;
+    Function* callee = i->getCalledFunction();
+    if ((callSummaries != nullptr) && (callee != nullptr) && !callee->isDeclaration() &&
+        !callSummaries->getReturnInterval(i->getFunction(), callee, arguments, &result)) {
+        unreachable = true;
+    }
+    int destSlot = slots->getSlot(i);
+    if (destSlot != SlotNumbering::NO_SLOT) {
+        setValueInterval(i, result);
+    }
 
-    // Returns reference to recently modified entry
-    return getPtrFromVariableName(variable.first);
+    // Returns index of recently modified entry
+    return destSlot;
 }
 
-IntervalTracker::var_t IntervalTracker::calculateArithmetic(Instruction* i, arithmetic_function_t callback) {
+template <IntervalTracker::transfer_t Callback>
+int IntervalTracker::calculateArithmetic(Instruction* i) {
     interval_t destInterval;
     for (auto val = i->value_op_begin(); val != i->value_op_end(); ++val) {
-        std::string currentName;
-        interval_t currentInterval;
-        if (val->hasName()) {
-            currentName = val->getName().str();
-            currentInterval = intervalsTracker[currentName];
-        }
-        else if (ConstantInt* numConstant = dyn_cast<ConstantInt>(*val)) {
-            int number = numConstant->getZExtValue();
-            currentInterval = std::make_tuple(number, number);
-        }
-        else {
-            std::stringstream registerValue;
-            registerValue << *val;
-            currentName = registerValue.str();
-            currentInterval = intervalsTracker[currentName];
+        interval_t currentInterval = getOperandInterval(*val);
+        destInterval = (val == i->value_op_begin()) ? currentInterval : (this->*Callback)(destInterval, currentInterval);
+    }
+    int destSlot = slots->getSlot(i);
+    if (destSlot != SlotNumbering::NO_SLOT) {
+        intervalsTracker.set(destSlot, i->getType()->isIntegerTy() ? Interval::fitToWidth(destInterval, i->getType()->getIntegerBitWidth()) : destInterval);
+    }
+
+    // Returns index of recently modified entry
+    return destSlot;
+}
+
+bool IntervalTracker::refineBranch(const BranchInst* branch, unsigned successor) {
+    // Keeps only the states that take the given successor, false when the
+    // edge cannot be taken at all
+    if (!branch->isConditional()) {
+        return true;
+    }
+    interval_t condition = getOperandInterval(branch->getCondition());
+    if ((successor == 0) ? (condition.upper == 0) : (condition.lower == 1)) {
+        return false;
+    }
+    const ICmpInst* compare = dyn_cast<ICmpInst>(branch->getCondition());
+    if ((compare == nullptr) || !compare->getOperand(0)->getType()->isIntegerTy()) {
+        return true;
+    }
+    CmpInst::Predicate predicate = (successor == 0) ? compare->getPredicate() : compare->getInversePredicate();
+    interval_t first = getOperandInterval(compare->getOperand(0));
+    interval_t second = getOperandInterval(compare->getOperand(1));
+    if (!refineComparison(predicate, &first, &second)) {
+        return false;
+    }
+    refineOperand(branch, compare, 0, first);
+    refineOperand(branch, compare, 1, second);
+    return true;
+}
+
+void IntervalTracker::refineOperand(const BranchInst* branch, const ICmpInst* compare, unsigned operand, interval_t interval) {
+    const Value* value = compare->getOperand(operand);
+    refineValue(value, interval);
+    if (const SExtInst* extension = dyn_cast<SExtInst>(value)) {
+        value = extension->getOperand(0);
+        refineValue(value, interval);
+    }
+
+    // The register still holds the variable it was loaded from when nothing
+    // between the load and the branch can write memory
+    const LoadInst* load = dyn_cast<LoadInst>(value);
+    if ((load == nullptr) || !isa<AllocaInst>(load->getPointerOperand()) || (load->getParent() != branch->getParent())) {
+        return;
+    }
+    for (const Instruction* next = load->getNextNode(); next != nullptr; next = next->getNextNode()) {
+        if (next->mayWriteToMemory()) {
+            return;
         }
-        destInterval = (val == i->value_op_begin()) ? currentInterval : callback(destInterval, currentInterval);
     }
-    std::string destName = i->getName().str();
-    var_t calculatedInterval = std::make_pair(destName, destInterval);
-    if (intervalsTracker.find(destName) == intervalsTracker.end()) {
-        intervalsTracker.insert(calculatedInterval);
+    refineValue(load->getPointerOperand(), interval);
+}
+
+void IntervalTracker::refineValue(const Value* value, interval_t interval) {
+    int slot = slots->getSlot(value);
+    if (slot == SlotNumbering::NO_SLOT) {
+        return;
     }
-    else {
-        intervalsTracker[destName] = destInterval;
+    interval_t current = intervalsTracker[slot];
+    interval_t refined = Interval::make(std::max(current.lower, interval.lower), std::min(current.upper, interval.upper));
+    if ((refined.lower > refined.upper) || Interval::isSame(refined, current)) {
+        return;
     }
+    // A concrete value the edge admits stays known, the recursive engine
+    // unrolls loops by it
+    intervalsTracker.set(slot, refined);
+    if (Interval::isConstant(refined)) {
+        valueTracker.editVariable(slot, ValueTracker::toValue(refined.lower));
+    }
+}
 
-    // Returns reference to recently modified entry
-    return calculatedInterval;
+IntervalTracker::interval_t IntervalTracker::getOperandInterval(Value* operand) const {
+    if (ConstantInt* numConstant = dyn_cast<ConstantInt>(operand)) {
+        return getConstantInterval(numConstant);
+    }
+    return getVariableInterval(slots->getSlot(operand));
 }
 
 IntervalTracker::interval_t IntervalTracker::addCallback(interval_t accumulator, interval_t current) {
-    double min = std::get<0>(accumulator);
-    double max = std::get<1>(accumulator);
-    double currentMin = std::get<0>(current);
-    double currentMax = std::get<1>(current);
-    double resultMin = 0.0;
-    double resultMax = 0.0;
     if (!isInLoop()) {
-        resultMin = (std::isnan(currentMin) || std::isnan(min)) ? std::nan("-infinity") : (min + currentMin);
-        resultMax = (std::isnan(currentMax) || std::isnan(max)) ? std::nan("+infinity") : (max + currentMax);
+        return Interval::add(accumulator, current);
     }
-    else {
-        resultMin = (std::isnan(max)) ? min : max;
-        resultMin = (std::isnan(resultMin)) ? std::nan("-infinity") : resultMin;
-        resultMax = std::nan("+infinity");
-    }
-    return std::make_tuple(resultMin, resultMax);
+    int64_t resultMin = (accumulator.upper == Interval::PLUS_INFINITY) ? accumulator.lower : accumulator.upper;
+    return Interval::make(resultMin, Interval::PLUS_INFINITY);
 }
 
 IntervalTracker::interval_t IntervalTracker::subCallback(interval_t accumulator, interval_t current) {
-    double min = std::get<0>(accumulator);
-    double max = std::get<1>(accumulator);
-    double currentMin = std::get<0>(current);
-    double currentMax = std::get<1>(current);
-    double resultMin = 0.0;
-    double resultMax = 0.0;
     if (!isInLoop()) {
-        resultMin = (std::isnan(currentMin) || std::isnan(min)) ? std::nan("-infinity") : (min - currentMin);
-        resultMax = (std::isnan(currentMax) || std::isnan(max)) ? std::nan("+infinity") : (max - currentMax);
-    }
-    else {
-        resultMin = std::nan("-infinity");
-        resultMax = (std::isnan(min)) ? max : min;
-        resultMax = (std::isnan(resultMax)) ? std::nan("+infinity") : resultMax;
+        return Interval::sub(accumulator, current);
     }
-    return std::make_tuple(resultMin, resultMax);
+    int64_t resultMax = (accumulator.lower == Interval::MINUS_INFINITY) ? accumulator.upper : accumulator.lower;
+    return Interval::make(Interval::MINUS_INFINITY, resultMax);
 }
 
 IntervalTracker::interval_t IntervalTracker::mulCallback(interval_t accumulator, interval_t current) {
-    double min = std::get<0>(accumulator);
-    double max = std::get<1>(accumulator);
-    double currentMin = std::get<0>(current);
-    double currentMax = std::get<1>(current);
-    double resultMin = 0.0;
-    double resultMax = 0.0;
     if (!isInLoop()) {
-        resultMin = (std::isnan(currentMin) || std::isnan(min)) ? std::nan("-infinity") : (min * currentMin);
-        resultMax = (std::isnan(currentMax) || std::isnan(max)) ? std::nan("+infinity") : (max * currentMax);
+        return Interval::mul(accumulator, current);
     }
-    else {
-        if (((min < 1) && (min > 0)) ||
-            ((max < 1) && (max > 0)) ||
-            ((currentMin < 1) && (currentMin > 0)) ||
-            ((currentMax < 1) && (currentMax > 0))) {
-            resultMin = 0;
-            resultMax = max;
-        }
-        else if (((min > -1) && (min < 0)) ||
-                ((max > -1) && (max < 0)) ||
-                ((currentMin > -1) && (currentMin < 0)) ||
-                ((currentMax > -1) && (currentMax < 0))) {
-            resultMin = min;
-            resultMax = 0;
-        }
-        else if (((min >= 1) && (max >= 1) && (currentMin >= 1) && (currentMax >= 1)) ||
-                 ((min <= -1) && (max <= -1) && (currentMin <= -1) && (currentMax <= -1))) {
-            resultMin = min;
-            resultMax = std::nan("+infinity");
-        }
-        else if (((min >= 1) && (max >= 1) && (currentMin <= 1) && (currentMax <= 1)) ||
-                 ((min <= -1) && (max <= -1) && (currentMin >= -1) && (currentMax >= -1))) {
-            resultMin = std::nan("-infinity");
-            resultMax = max;
+
+    // Inside a loop the product keeps growing in the direction the signs push it
+    bool finite = Interval::isFinite(accumulator) && Interval::isFinite(current);
+    bool accumulatorPositive = (accumulator.lower >= 1) && (accumulator.upper >= 1);
+    bool accumulatorNegative = (accumulator.lower <= -1) && (accumulator.upper <= -1);
+    if (finite && ((accumulatorPositive && (current.lower >= 1) && (current.upper >= 1)) ||
+                   (accumulatorNegative && (current.lower <= -1) && (current.upper <= -1)))) {
+        return Interval::make(accumulator.lower, Interval::PLUS_INFINITY);
+    }
+    if (finite && ((accumulatorPositive && (current.lower <= 1) && (current.upper <= 1)) ||
+                   (accumulatorNegative && (current.lower >= -1) && (current.upper >= -1)))) {
+        return Interval::make(Interval::MINUS_INFINITY, accumulator.upper);
+    }
+    return accumulator;
+}
+
+static IntervalTracker::interval_t topInterval() {
+    return Interval::top();
+}
+
+static bool isFinite(IntervalTracker::interval_t interval) {
+    return Interval::isFinite(interval);
+}
+
+static bool isNonNegative(IntervalTracker::interval_t interval) {
+    return isFinite(interval) && (interval.lower >= 0);
+}
+
+// Smallest all-ones number covering value, which bounds any bitwise mix of smaller numbers
+static int64_t getAllOnesBound(int64_t value) {
+    uint64_t bound = 1;
+    while ((bound <= (uint64_t) value) && (bound < (UINT64_C(1) << 63))) {
+        bound <<= 1;
+    }
+    return bound - 1;
+}
+
+// Truncating division by a divisor interval that does not contain zero
+static IntervalTracker::interval_t divideInterval(IntervalTracker::interval_t dividend, int64_t divisorMin, int64_t divisorMax) {
+    int64_t quotients[] = {dividend.lower / divisorMin, dividend.lower / divisorMax, dividend.upper / divisorMin, dividend.upper / divisorMax};
+    return Interval::make(*std::min_element(quotients, quotients + 4), *std::max_element(quotients, quotients + 4));
+}
+
+IntervalTracker::interval_t IntervalTracker::sdivCallback(interval_t accumulator, interval_t current) {
+    if (!isFinite(accumulator) || !isFinite(current) || ((current.lower == 0) && (current.upper == 0))) {
+        return topInterval();
+    }
+    // Split a divisor straddling zero into its negative and positive parts
+    if ((current.lower <= 0) && (current.upper >= 0)) {
+        if (current.lower == 0) {
+            return divideInterval(accumulator, 1, current.upper);
         }
-        else {
-            resultMin = min;
-            resultMax = max;
+        if (current.upper == 0) {
+            return divideInterval(accumulator, current.lower, -1);
         }
+        return joinInterval(divideInterval(accumulator, current.lower, -1), divideInterval(accumulator, 1, current.upper));
+    }
+    return divideInterval(accumulator, current.lower, current.upper);
+}
+
+IntervalTracker::interval_t IntervalTracker::udivCallback(interval_t accumulator, interval_t current) {
+    // Non-negative operands read the same signed or unsigned
+    return (isNonNegative(accumulator) && isNonNegative(current)) ? sdivCallback(accumulator, current) : topInterval();
+}
+
+IntervalTracker::interval_t IntervalTracker::uremCallback(interval_t accumulator, interval_t current) {
+    if (!isNonNegative(accumulator) || !isNonNegative(current) || (current.upper < 1)) {
+        return topInterval();
     }
-    return std::make_tuple(resultMin, resultMax);
+    return Interval::make(0, std::min(accumulator.upper, current.upper - 1));
 }
 
 IntervalTracker::interval_t IntervalTracker::sremCallback(interval_t accumulator, interval_t current) {
-    double currentMin = std::get<0>(current);
-    double currentMax = std::get<1>(current);
-    double resultMin = (std::isnan(currentMin)) ? std::nan("-infinity") : 0;
-    double resultMax = (std::isnan(currentMax)) ? std::nan("+infinity") : currentMax;
-    return std::make_tuple(resultMin, resultMax);
+    if ((current.lower == 0) && (current.upper == 0)) {
+        return topInterval();
+    }
+    if (Interval::isConstant(accumulator) && Interval::isConstant(current) && isFinite(accumulator) && (current.lower != 0) && (current.lower != -1)) {
+        return Interval::constant(accumulator.lower % current.lower);
+    }
+    // The remainder takes the sign of the dividend, and stays below the
+    // largest divisor magnitude and within the dividend's own magnitude
+    int64_t bound = Interval::PLUS_INFINITY, negativeBound = Interval::MINUS_INFINITY;
+    if (isFinite(current)) {
+        bound = std::max(-current.lower, current.upper) - 1;
+        negativeBound = -bound;
+    }
+    int64_t lower = (accumulator.lower >= 0) ? 0 : std::max(accumulator.lower, negativeBound);
+    int64_t upper = (accumulator.upper <= 0) ? 0 : std::min(accumulator.upper, bound);
+    return Interval::make(lower, upper);
+}
+
+IntervalTracker::interval_t IntervalTracker::shlCallback(interval_t accumulator, interval_t current) {
+    if (!isFinite(accumulator) || !isNonNegative(current) || (current.upper > 62)) {
+        return topInterval();
+    }
+    // Shifting left multiplies by a power of two
+    return Interval::mul(accumulator, Interval::make(INT64_C(1) << current.lower, INT64_C(1) << current.upper));
+}
+
+IntervalTracker::interval_t IntervalTracker::lshrCallback(interval_t accumulator, interval_t current) {
+    return isNonNegative(accumulator) ? ashrCallback(accumulator, current) : topInterval();
+}
+
+IntervalTracker::interval_t IntervalTracker::ashrCallback(interval_t accumulator, interval_t current) {
+    if (!isFinite(accumulator) || !isNonNegative(current) || (current.upper > 63)) {
+        return topInterval();
+    }
+    // Shifting right is a division by a power of two rounding towards -infinity
+    return Interval::make(std::min(accumulator.lower >> current.lower, accumulator.lower >> current.upper),
+                          std::max(accumulator.upper >> current.lower, accumulator.upper >> current.upper));
 }
+
+IntervalTracker::interval_t IntervalTracker::andCallback(interval_t accumulator, interval_t current) {
+    // Masking with a non-negative number can only clear bits
+    if (isNonNegative(accumulator) && isNonNegative(current)) {
+        return Interval::make(0, std::min(accumulator.upper, current.upper));
+    }
+    if (isNonNegative(accumulator)) {
+        return Interval::make(0, accumulator.upper);
+    }
+    if (isNonNegative(current)) {
+        return Interval::make(0, current.upper);
+    }
+    return topInterval();
+}
+
+IntervalTracker::interval_t IntervalTracker::orCallback(interval_t accumulator, interval_t current) {
+    if (!isNonNegative(accumulator) || !isNonNegative(current)) {
+        return topInterval();
+    }
+    return Interval::make(std::max(accumulator.lower, current.lower), getAllOnesBound(std::max(accumulator.upper, current.upper)));
+}
+
+IntervalTracker::interval_t IntervalTracker::xorCallback(interval_t accumulator, interval_t current) {
+    if (!isNonNegative(accumulator) || !isNonNegative(current)) {
+        return topInterval();
+    }
+    return Interval::make(0, getAllOnesBound(std::max(accumulator.upper, current.upper)));
+}
+
+IntervalTracker::interval_t IntervalTracker::unknownCallback(interval_t, interval_t) {
+    return topInterval();
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include "llvm/Analysis/CaptureTracking.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Instruction.h"
+#include "../../include/Tracker/SlotNumbering.h"
+
+SlotNumbering::SlotNumbering(Function* function) {
+    for (auto &argument: function->args()) {
+        if (argument.getType()->isIntegerTy()) {
+            numberValue(&argument);
+        }
+    }
+    for (auto &BB: *function) {
+        for (auto &I: BB) {
+            if (isa<AllocaInst>(&I) ||
+                isa<LoadInst>(&I) ||
+                isa<CmpInst>(&I) ||
+                isa<BinaryOperator>(&I) ||
+                isa<TruncInst>(&I) ||
+                isa<ZExtInst>(&I) ||
+                isa<SExtInst>(&I) ||
+                isa<SelectInst>(&I) ||
+                (isa<CallInst>(&I) && I.getType()->isIntegerTy())) {
+                numberValue(&I);
+            }
+            if (isa<AllocaInst>(&I) && PointerMayBeCaptured(&I, true, true)) {
+                escapedSlots.push_back(getSlot(&I));
+            }
+        }
+    }
+}
+
+int SlotNumbering::getSlot(const Value* value) const {
+    auto slot = valueSlots.find(value);
+    return (slot != valueSlots.end()) ? static_cast<int>(slot->second) : NO_SLOT;
+}
+
+int SlotNumbering::getSlot(std::string name) const {
+    auto slot = namedSlots.find(name);
+    return (slot != namedSlots.end()) ? static_cast<int>(slot->second) : NO_SLOT;
+}
+
+const Value* SlotNumbering::getValue(unsigned slot) const {
+    return slotValues[slot];
+}
+
+std::string SlotNumbering::getSlotName(unsigned slot) const {
+    const Value* value = slotValues[slot];
+    if (value->hasName()) {
+        return value->getName().str();
+    }
+    // Unnamed registers are only needed for debugging dumps
+    std::stringstream registerValue;
+    registerValue << (const void*)value;
+    return registerValue.str();
+}
+
+unsigned SlotNumbering::size() const {
+    return slotValues.size();
+}
+
+std::vector<int> SlotNumbering::getClobberedSlots(const CallInst* call) const {
+    // Variables whose address escaped, and those handed to the callee
+    // through casts or element pointers
+    std::vector<int> clobbered;
+    if (call->onlyReadsMemory()) {
+        return clobbered;
+    }
+    clobbered = escapedSlots;
+    for (const Value* argument : call->args()) {
+        if (!argument->getType()->isPointerTy()) {
+            continue;
+        }
+        const Value* object = getUnderlyingObject(argument);
+        int slot = isa<AllocaInst>(object) ? getSlot(object) : NO_SLOT;
+        if ((slot != NO_SLOT) && (std::find(clobbered.begin(), clobbered.end(), slot) == clobbered.end())) {
+            clobbered.push_back(slot);
+        }
+    }
+    return clobbered;
+}
+
+void SlotNumbering::numberValue(const Value* value) {
+    unsigned slot = slotValues.size();
+    slotValues.push_back(value);
+    valueSlots[value] = slot;
+    if (value->hasName()) {
+        namedSlots[value->getName().str()] = slot;
+    }
+}
\ No newline at end of file
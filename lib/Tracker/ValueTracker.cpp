@@ -1,219 +1,302 @@
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <iostream>
 #include <string>
-#include <sstream>
 #include <unordered_map>
+#include <vector>
+#include "llvm/ADT/APInt.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Constants.h"
+#include "../../include/Support/Log.h"
+#include "../../include/Tracker/IntervalTracker.h"
 #include "../../include/Tracker/ValueTracker.h"
 
-ValueTracker::var_t ValueTracker::getVariableFromPtr(void* ptr) {
-    // TODO: Add some error handling if ptr == nullptr
-    return *static_cast<var_t*>(ptr);
+ValueTracker::ValueTracker(const SlotNumbering* slots, Arena* arena)
+    : slots(slots), variablesTracker(slots ? slots->size() : 0, std::nan("undefined"), arena) {
 }
 
-void* ValueTracker::getPtrFromVariableName(std::string name) {
-    var_it_t variableIterator = variablesTracker.find(name);
-    if (variableIterator == variablesTracker.end()) {
-        return nullptr;
-    }
-    var_t variable = std::make_pair(variableIterator->first, variableIterator->second);
-    void* elementPtr = &variable;
-    return elementPtr;
+double ValueTracker::getVariableValue(int slot) const {
+    return (slot != SlotNumbering::NO_SLOT) ? variablesTracker[slot] : std::nan("undefined");
 }
 
-double ValueTracker::getVariableValue(std::string name) {
-    return (variablesTracker.find(name) != variablesTracker.end()) ? variablesTracker[name] : std::nan("undefined");
+double ValueTracker::getVariableValue(std::string name) const {
+    return getVariableValue(slots->getSlot(name));
 }
 
-void ValueTracker::editVariable(std::string name, double value) {
-    variablesTracker[name] = value;
+void ValueTracker::editVariable(int slot, double value) {
+    if (slot != SlotNumbering::NO_SLOT) {
+        variablesTracker.set(slot, value);
+    }
 }
 
-ValueTracker::var_map_t ValueTracker::getValueTracker() const {
-    return variablesTracker;
+double ValueTracker::getOperandValue(Value* operand) const {
+    if (ConstantInt* numConstant = dyn_cast<ConstantInt>(operand)) {
+        // Constants read as their intervals do, wider than 64 bits is unknown
+        IntervalTracker::interval_t constant = IntervalTracker::getConstantInterval(numConstant);
+        return Interval::isConstant(constant) ? toValue(constant.lower) : std::nan("undefined");
+    }
+    return getVariableValue(slots->getSlot(operand));
 }
 
-void ValueTracker::setTracker(var_map_t tracker) {
-    variablesTracker = var_map_t(tracker);
+bool ValueTracker::isExact(double value) {
+    // Below 2^53 every integer is a double, and a sum or product that reached
+    // 2^53 may already have been rounded
+    return !std::isnan(value) && (std::fabs(value) <= (double) MAX_EXACT_VALUE);
 }
 
-void ValueTracker::printTracker() {
-    for (auto variable = variablesTracker.begin(); variable != variablesTracker.end(); ++variable) {
-        printf("Key: %s - Value: %lf\n", variable->first.c_str(), variable->second);
-    }
-    printf("\n");
+double ValueTracker::toValue(int64_t number) {
+    return ((number >= -MAX_EXACT_VALUE) && (number <= MAX_EXACT_VALUE)) ? (double) number : std::nan("undefined");
 }
 
-void* ValueTracker::processNewEntry(Instruction* i) {
-    if (isa<AllocaInst>(i)) {
-        return allocateNewVariable(dyn_cast<AllocaInst>(i));
-    }
-    else if (isa<StoreInst>(i)) {
-        return storeValueIntoVariable(dyn_cast<StoreInst>(i));
-    }
-    else if (isa<LoadInst>(i)) {
-        return loadVariableIntoRegister(dyn_cast<LoadInst>(i));
+double ValueTracker::fitToWidth(double value, Type* type) {
+    // Anything rounded or outside the type may have wrapped around
+    if (std::isnan(value) || !type->isIntegerTy()) {
+        return value;
     }
-    else if (isa<CmpInst>(i)) {
-        return compareValues(dyn_cast<CmpInst>(i));
-    }
-    else if (isa<BinaryOperator>(i)) {
-        return processCalculation(dyn_cast<BinaryOperator>(i));
+    if (!isExact(value)) {
+        return std::nan("undefined");
     }
-    return nullptr;
+    Interval::interval_t fitted = Interval::fitToWidth(Interval::constant((int64_t) value), type->getIntegerBitWidth());
+    return Interval::isConstant(fitted) ? value : std::nan("undefined");
+}
+
+const SlotNumbering* ValueTracker::getSlotNumbering() const {
+    return slots;
 }
 
-void* ValueTracker::allocateNewVariable(AllocaInst* i) {
-    std::string varName;
-    if (!i->hasName()) {
-        return nullptr;
+ValueTracker::var_map_t ValueTracker::getValueTracker() const {
+    // Name-keyed view of the state, only rebuilt for reports
+    var_map_t tracker;
+    for (unsigned slot = 0; slot < variablesTracker.size(); ++slot) {
+        tracker[slots->getSlotName(slot)] = variablesTracker[slot];
     }
-    varName = i->getName().str();
-    var_t variable = std::make_pair(varName, std::nan("inifinity"));
-    variablesTracker.insert(variable);
+    return tracker;
+}
+
+bool ValueTracker::joinTracker(const ValueTracker& other) {
+    return variablesTracker.combineWith(other.variablesTracker, [](double& value, const double& otherValue) {
+        // Concrete values only survive a merge when both sides agree on them
+        if (!std::isnan(value) && (std::isnan(otherValue) || (value != otherValue))) {
+            value = std::nan("undefined");
+            return true;
+        }
+        return false;
+    });
+}
 
-    // Returns reference to newly created entry
-    return getPtrFromVariableName(varName);
+bool ValueTracker::includesTracker(const ValueTracker& other) const {
+    // Holds when a join with other would leave every value as it is
+    return variablesTracker.testLeavesWith(other.variablesTracker, [](const ArrayLeaf<double>& values, const ArrayLeaf<double>& otherValues) {
+        for (unsigned i = 0; i < slot_state_t::BRANCHING; ++i) {
+            if (!std::isnan(values.get(i)) && (values.get(i) != otherValues.get(i))) {
+                return false;
+            }
+        }
+        return true;
+    });
 }
 
-void* ValueTracker::storeValueIntoVariable(StoreInst* i) {
-    double src;
-    if (i->getOperand(0)->hasName()) {
-        var_map_t::const_iterator existingVariable = variablesTracker.find(i->getOperand(0)->getName().str());
-        src = existingVariable->second;
+void ValueTracker::printTracker() {
+    for (unsigned slot = 0; slot < variablesTracker.size(); ++slot) {
+        LOG(LOG_TRACE, "Key: %s - Value: %lf\n", slots->getSlotName(slot).c_str(), variablesTracker[slot]);
     }
-    else {
-        ConstantInt* ci = dyn_cast<ConstantInt>(i->getOperand(0));
-        src = ci->getSExtValue();
+    LOG(LOG_TRACE, "\n");
+}
+
+int ValueTracker::processNewEntry(Instruction* i) {
+    switch (i->getOpcode()) {
+        case Instruction::Alloca:
+            return allocateNewVariable(cast<AllocaInst>(i));
+        case Instruction::Store:
+            return storeValueIntoVariable(cast<StoreInst>(i));
+        case Instruction::Load:
+            return loadVariableIntoRegister(cast<LoadInst>(i));
+        case Instruction::ICmp:
+        case Instruction::FCmp:
+            return compareValues(cast<CmpInst>(i));
+        case Instruction::Trunc:
+        case Instruction::ZExt:
+        case Instruction::SExt:
+            return processCast(cast<CastInst>(i));
+        case Instruction::Select:
+            return processSelect(cast<SelectInst>(i));
+        case Instruction::Call:
+            return processCall(cast<CallInst>(i));
+        default:
+            if (BinaryOperator* binaryOperator = dyn_cast<BinaryOperator>(i)) {
+                return processCalculation(binaryOperator);
+            }
+            return SlotNumbering::NO_SLOT;
     }
-    std::string dest = i->getOperand(1)->getName().str();
-    variablesTracker[dest] = src;
+}
+
+int ValueTracker::allocateNewVariable(AllocaInst* i) {
+    int slot = slots->getSlot(i);
+    editVariable(slot, std::nan("inifinity"));
 
-    // Returns reference to recently modified entry
-    return getPtrFromVariableName(dest);
+    // Returns index of newly created entry
+    return slot;
 }
 
-void* ValueTracker::loadVariableIntoRegister(LoadInst* i) {
-    std::string variableName = i->getOperand(0)->getName().str();
-    double variableValue = variablesTracker[variableName];
-    std::stringstream registerValue;
-    registerValue << (void*)i;
-    std::string registerString = registerValue.str();
-    var_t registerVariable = std::make_pair(registerString, variableValue);
-    if (variablesTracker.find(registerString) == variablesTracker.end()) {
-        variablesTracker.insert(registerVariable);
-    }
-    else {
-        variablesTracker[registerString] = variableValue;
-    }
+int ValueTracker::storeValueIntoVariable(StoreInst* i) {
+    double src = getOperandValue(i->getOperand(0));
+    int dest = slots->getSlot(i->getOperand(1));
+    editVariable(dest, src);
+
+    // Returns index of recently modified entry
+    return dest;
+}
+
+int ValueTracker::loadVariableIntoRegister(LoadInst* i) {
+    double variableValue = getVariableValue(slots->getSlot(i->getOperand(0)));
+    int registerSlot = slots->getSlot(i);
+    editVariable(registerSlot, variableValue);
 
-    // Returns reference to recently added register entry
-    return getPtrFromVariableName(registerString);
+    // Returns index of recently added register entry
+    return registerSlot;
 }
 
-void* ValueTracker::compareValues(CmpInst* i) {
-    arithmetic_function_t comparison;
+int ValueTracker::compareValues(CmpInst* i) {
+    // Non-negative operands order the same signed or unsigned
+    if (i->isUnsigned() && ((getOperandValue(i->getOperand(0)) < 0) || (getOperandValue(i->getOperand(1)) < 0))) {
+        return calculateArithmetic<&ValueTracker::unknownCallback>(i);
+    }
+
+    // Returns index of recently modified entry
     switch (i->getPredicate()) {
         case CmpInst::ICMP_EQ:
-            comparison = std::bind(&ValueTracker::equalToCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::equalToCallback>(i);
         case CmpInst::ICMP_NE:
-            comparison = std::bind(&ValueTracker::notEqualToCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::notEqualToCallback>(i);
         case CmpInst::ICMP_UGT:
-            comparison = std::bind(&ValueTracker::greaterThanCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
-        case CmpInst::ICMP_UGE:
-            comparison = std::bind(&ValueTracker::greaterThanOrEqualCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
-        case CmpInst::ICMP_ULT:
-            comparison = std::bind(&ValueTracker::lessThanCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
-        case CmpInst::ICMP_ULE:
-            comparison = std::bind(&ValueTracker::lessThanOrEqualCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
         case CmpInst::ICMP_SGT:
-            comparison = std::bind(&ValueTracker::greaterThanCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::greaterThanCallback>(i);
+        case CmpInst::ICMP_UGE:
         case CmpInst::ICMP_SGE:
-            comparison = std::bind(&ValueTracker::greaterThanOrEqualCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::greaterThanOrEqualCallback>(i);
+        case CmpInst::ICMP_ULT:
         case CmpInst::ICMP_SLT:
-            comparison = std::bind(&ValueTracker::lessThanCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::lessThanCallback>(i);
+        case CmpInst::ICMP_ULE:
         case CmpInst::ICMP_SLE:
-            comparison = std::bind(&ValueTracker::lessThanOrEqualCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::lessThanOrEqualCallback>(i);
         default:
-            printf("\nCompare Instruction with Predicate %d not supported.\n", i->getPredicate());
-            break;
+            LOG(LOG_WARN, "compare instruction with predicate %d not supported\n", i->getPredicate());
+            return calculateArithmetic<&ValueTracker::unknownCallback>(i);
     }
-    var_t variable = calculateArithmetic(i, comparison);
-
-    // Returns reference to recently modified entry
-    return getPtrFromVariableName(variable.first);
 }
 
-void* ValueTracker::processCalculation(BinaryOperator* i) {
-    arithmetic_function_t calculation;
+int ValueTracker::processCalculation(BinaryOperator* i) {
+    // Returns index of recently modified entry
     switch (i->getOpcode()) {
         case Instruction::Add:
-            calculation = std::bind(&ValueTracker::addCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
-        case Instruction::Mul:
-            calculation = std::bind(&ValueTracker::mulCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::addCallback>(i);
         case Instruction::Sub:
-            calculation = std::bind(&ValueTracker::subCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::subCallback>(i);
+        case Instruction::Mul:
+            return calculateArithmetic<&ValueTracker::mulCallback>(i);
+        case Instruction::SDiv:
+            return calculateArithmetic<&ValueTracker::sdivCallback>(i);
+        case Instruction::UDiv:
+            return calculateArithmetic<&ValueTracker::udivCallback>(i);
         case Instruction::SRem:
-            calculation = std::bind(&ValueTracker::sremCallback, this, std::placeholders::_1, std::placeholders::_2);
-            break;
+            return calculateArithmetic<&ValueTracker::sremCallback>(i);
+        case Instruction::URem:
+            return calculateArithmetic<&ValueTracker::uremCallback>(i);
+        case Instruction::Shl:
+            return calculateArithmetic<&ValueTracker::shlCallback>(i);
+        case Instruction::LShr:
+            return calculateArithmetic<&ValueTracker::lshrCallback>(i);
+        case Instruction::AShr:
+            return calculateArithmetic<&ValueTracker::ashrCallback>(i);
+        case Instruction::And:
+            return calculateArithmetic<&ValueTracker::andCallback>(i);
+        case Instruction::Or:
+            return calculateArithmetic<&ValueTracker::orCallback>(i);
+        case Instruction::Xor:
+            return calculateArithmetic<&ValueTracker::xorCallback>(i);
         default:
-            break;
+            return calculateArithmetic<&ValueTracker::unknownCallback>(i);
     }
-    var_t variable = calculateArithmetic(i, calculation);
-
-    // Returns reference to recently modified entry
-    return getPtrFromVariableName(variable.first);
 }
 
-ValueTracker::var_t ValueTracker::calculateArithmetic(Instruction* i, arithmetic_function_t callback) {
-    double destValue;
-    for (auto val = i->value_op_begin(); val != i->value_op_end(); ++val) {
-        std::string currentName;
-        double currentValue;
-        if (val->hasName()) {
-            currentName = val->getName().str();
-            currentValue = variablesTracker[currentName];
-        }
-        else if (ConstantInt* numConstant = dyn_cast<ConstantInt>(*val)) {
-            currentValue = numConstant->getZExtValue();
+int ValueTracker::processCast(CastInst* i) {
+    double src = getOperandValue(i->getOperand(0));
+    unsigned srcBits = i->getSrcTy()->getIntegerBitWidth();
+    unsigned destBits = i->getDestTy()->getIntegerBitWidth();
+    double dest = src;
+    if (!std::isnan(src)) {
+        int64_t number = (int64_t) src;
+        switch (i->getOpcode()) {
+            case Instruction::Trunc:
+                // i1 keeps its low bit, wider types wrap into their signed range
+                dest = (destBits == 1) ? (double) (number & 1) : (double) APInt(64, number, true).trunc(destBits).getSExtValue();
+                break;
+            case Instruction::ZExt:
+                dest = (double) APInt(64, number, true).trunc(srcBits).getZExtValue();
+                break;
+            case Instruction::SExt:
+                // A set i1 sign-extends to -1
+                dest = (srcBits == 1) ? -(double) (number & 1) : src;
+                break;
+            default:
+                break;
         }
-        else {
-            std::stringstream registerValue;
-            registerValue << *val;
-            currentName = registerValue.str();
-            currentValue = variablesTracker[currentName];
-        }
-        destValue = (val == i->value_op_begin()) ? currentValue : callback(destValue, currentValue);
     }
-    std::string destName = i->getName().str();
-    var_t calculatedVariable = std::make_pair(destName, destValue);
-    if (variablesTracker.find(destName) == variablesTracker.end()) {
-        variablesTracker.insert(calculatedVariable);
+    int destSlot = slots->getSlot(i);
+    editVariable(destSlot, fitToWidth(dest, i->getDestTy()));
+
+    // Returns index of recently modified entry
+    return destSlot;
+}
+
+int ValueTracker::processSelect(SelectInst* i) {
+    double condition = getOperandValue(i->getCondition());
+    double trueValue = getOperandValue(i->getTrueValue());
+    double falseValue = getOperandValue(i->getFalseValue());
+    double dest = std::nan("undefined");
+    if (!std::isnan(condition)) {
+        dest = (condition != 0) ? trueValue : falseValue;
+    }
+    else if (trueValue == falseValue) {
+        dest = trueValue;
+    }
+    int destSlot = slots->getSlot(i);
+    editVariable(destSlot, dest);
+
+    // Returns index of recently modified entry
+    return destSlot;
+}
+
+int ValueTracker::processCall(CallInst* i) {
+    // The callee may write any variable whose address it can reach
+    for (int slot : slots->getClobberedSlots(i)) {
+        editVariable(slot, std::nan("undefined"));
     }
-    else {
-        variablesTracker[destName] = destValue;
+    int destSlot = slots->getSlot(i);
+    editVariable(destSlot, std::nan("undefined"));
+
+    // Returns index of recently modified entry
+    return destSlot;
+}
+
+template <ValueTracker::transfer_t Callback>
+int ValueTracker::calculateArithmetic(Instruction* i) {
+    double destValue = std::nan("undefined");
+    for (auto val = i->value_op_begin(); val != i->value_op_end(); ++val) {
+        double currentValue = getOperandValue(*val);
+        destValue = (val == i->value_op_begin()) ? currentValue : (this->*Callback)(destValue, currentValue);
     }
+    int destSlot = slots->getSlot(i);
+    editVariable(destSlot, fitToWidth(destValue, i->getType()));
 
-    // Returns reference to recently modified entry
-    return calculatedVariable;
+    // Returns index of recently modified entry
+    return destSlot;
 }
 
 double ValueTracker::addCallback(double accumulator, double current) {
@@ -247,11 +330,14 @@ double ValueTracker::mulCallback(double accumulator, double current) {
 }
 
 double ValueTracker::sremCallback(double accumulator, double current) {
-    if (std::isnan(current)) {
-        return std::nan("inifinity");
+    if (std::isnan(accumulator) ||
+        std::isnan(current) ||
+        (current == 0)) {
+        return std::nan("undefined");
     }
     else {
-        return current;
+        // Truncating remainder, with the sign of the dividend
+        return std::fmod(accumulator, current);
     }
 }
 
@@ -314,3 +400,103 @@ double ValueTracker::lessThanOrEqualCallback(double accumulator, double current)
         return (accumulator <= current) ? 1.0 : 0.0;
     }
 }
+
+double ValueTracker::sdivCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current) ||
+        (current == 0)) {
+        return std::nan("undefined");
+    }
+    else {
+        return std::trunc(accumulator / current);
+    }
+}
+
+double ValueTracker::udivCallback(double accumulator, double current) {
+    if ((accumulator < 0) ||
+        (current < 0)) {
+        return std::nan("undefined");
+    }
+    else {
+        return sdivCallback(accumulator, current);
+    }
+}
+
+double ValueTracker::uremCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current) ||
+        (accumulator < 0) ||
+        (current <= 0)) {
+        return std::nan("undefined");
+    }
+    else {
+        return std::fmod(accumulator, current);
+    }
+}
+
+double ValueTracker::shlCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current) ||
+        (current < 0) ||
+        (current > 62)) {
+        return std::nan("undefined");
+    }
+    else {
+        return std::ldexp(accumulator, (int) current);
+    }
+}
+
+double ValueTracker::lshrCallback(double accumulator, double current) {
+    if (accumulator < 0) {
+        return std::nan("undefined");
+    }
+    else {
+        return ashrCallback(accumulator, current);
+    }
+}
+
+double ValueTracker::ashrCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current) ||
+        (current < 0) ||
+        (current > 63)) {
+        return std::nan("undefined");
+    }
+    else {
+        return std::floor(std::ldexp(accumulator, -(int) current));
+    }
+}
+
+double ValueTracker::andCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current)) {
+        return std::nan("undefined");
+    }
+    else {
+        return (double) ((int64_t) accumulator & (int64_t) current);
+    }
+}
+
+double ValueTracker::orCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current)) {
+        return std::nan("undefined");
+    }
+    else {
+        return (double) ((int64_t) accumulator | (int64_t) current);
+    }
+}
+
+double ValueTracker::xorCallback(double accumulator, double current) {
+    if (std::isnan(accumulator) ||
+        std::isnan(current)) {
+        return std::nan("undefined");
+    }
+    else {
+        return (double) ((int64_t) accumulator ^ (int64_t) current);
+    }
+}
+
+double ValueTracker::unknownCallback(double, double) {
+    return std::nan("undefined");
+}
\ No newline at end of file
@@ -0,0 +1,9 @@
+int inspect(const int* value) __attribute__((pure));
+
+int main() {
+    int x = 7;
+    // A pure callee may read x through its address but never writes it.
+    // Without the attribute x becomes unknown after the call
+    inspect(&x);
+    return x;
+}
@@ -0,0 +1,7 @@
+int main () {
+    // 2^53 + 1 is the first integer a double cannot hold, so y is only
+    // exact when the analysis never rounds x through one
+    long long x = 9007199254740993LL;
+    long long y = x + 2;
+    return y == 9007199254740995LL;
+}
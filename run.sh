@@ -4,6 +4,10 @@ elif [ $1 = "2" ]; then
     bin/IntervalPass resources/example2.ll x
 elif [ $1 = "3" ]; then
     bin/IntervalPass resources/example3.ll y
+elif [ $1 = "4" ]; then
+    bin/IntervalPass resources/example4.ll x
+elif [ $1 = "5" ]; then
+    bin/IntervalPass resources/example5.ll y
 else
-    echo "Please enter the option 1, 2, or 3 for the example file you would like to run difference analysis on."
+    echo "Please enter the option 1, 2, 3, 4, or 5 for the example file you would like to run difference analysis on."
 fi
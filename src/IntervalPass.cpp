@@ -8,11 +8,22 @@
  *  Contact: e0210381@u.nus.edu
  */
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/resource.h>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <unordered_map>
 #include <set>
 #include <stack>
+#include <thread>
+#include <utility>
+#include <vector>
 #include <sstream>
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -21,10 +32,29 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
+#include "../include/Analyzer/AnalysisBudget.h"
+#include "../include/Analyzer/ContextTrie.h"
+#include "../include/Analyzer/FunctionHasher.h"
+#include "../include/Analyzer/FunctionSummaries.h"
 #include "../include/Analyzer/IntervalAnalyzer.h"
+#include "../include/Analyzer/LoopStructure.h"
+#include "../include/Analyzer/MappedResultCache.h"
+#include "../include/Analyzer/ResultCache.h"
+#include "../include/Analyzer/SeparationTracker.h"
+#include "../include/Analyzer/SparseEngine.h"
+#include "../include/Analyzer/WorklistEngine.h"
+#include "../include/Support/Arena.h"
+#include "../include/Support/BoundedQueue.h"
+#include "../include/Support/Log.h"
+#include "../include/Support/Profiler.h"
+#include "../include/Support/ReportWriter.h"
+#include "../include/Support/StringUtils.h"
+#include "../include/Support/WorkStealingPool.h"
 #include "../include/Tracker/IntervalTracker.h"
+#include "../include/Tracker/SlotNumbering.h"
 
 #define ANSI_COLOR_RED     "\x1b[31m"
 #define ANSI_COLOR_GREEN   "\x1b[32m"
@@ -36,8 +66,45 @@
 
 #define DEPTH_SEPARATOR '/'
 #define MAIN_FUNCTION "main"
-#define LOOP_BEGIN_BLOCK_NAME "while.cond"
-#define LOOP_END_BLOCK_NAME "while.end"
+#define ENGINE_OPTION "--engine="
+#define ENGINE_RECURSIVE "recursive"
+#define ENGINE_WORKLIST "worklist"
+#define ENGINE_SPARSE "sparse"
+#define ALL_VARIABLES_OPTION "--all"
+#define THRESHOLDS_OPTION "--thresholds="
+#define THRESHOLDS_NONE "none"
+#define NARROWING_OPTION "--narrowing="
+#define ALL_FUNCTIONS_OPTION "--all-functions"
+#define JOBS_OPTION "--jobs="
+#define SPEEDUP_OPTION "--speedup"
+#define BENCH_JSON_OPTION "--bench-json="
+#define BATCH_OPTION "--batch="
+#define LOAD_OPTION "--load="
+#define LOAD_LAZY "lazy"
+#define LOAD_EAGER "eager"
+#define PROFILE_OPTION "--profile="
+#define PROFILE_SUMMARY_SUFFIX ".json"
+#define PROFILE_TRACE_SUFFIX ".trace.json"
+#define LOG_OPTION "--log="
+#define FORMAT_OPTION "--format="
+#define FORMAT_TEXT "text"
+#define OUTPUT_OPTION "--output="
+#define INCREMENTAL_OPTION "--incremental="
+#define CACHE_OPTION "--cache="
+#define INTERPROCEDURAL_OPTION "--interprocedural="
+#define SEPARATION_OPTION "--separation="
+#define BUDGET_OPTION "--budget="
+#define BUDGET_CONTEXTS "contexts"
+#define BUDGET_VISITS "visits"
+#define BUDGET_MEMORY "memory"
+#define BUDGET_TIME "time"
+#define BYTES_PER_MEGABYTE (1024 * 1024)
+#define SWITCH_ON "on"
+#define SWITCH_OFF "off"
+#define BATCH_MANIFEST_PREFIX '@'
+#define MANIFEST_COMMENT '#'
+#define VARIABLE_SEPARATOR ','
+#define PAIR_SEPARATOR ':'
 
 using namespace llvm;
 
@@ -46,90 +113,904 @@ enum AnalyzeLoopBackedgeSwtch {
     OFF
 };
 
-typedef std::tuple<IntervalTracker::var_map_t, IntervalAnalyzer> analysis_package_t;
+enum AnalysisEngine {
+    RECURSIVE,
+    WORKLIST,
+    SPARSE
+};
+
+// Intervals of every analyzed variable, keyed on the context they were found in
+typedef std::unordered_map<ContextTrie::context_id_t, IntervalAnalyzer::interval_list_t> context_report_t;
+typedef std::tuple<context_report_t, IntervalAnalyzer> analysis_package_t;
+
+typedef struct {
+    AnalysisEngine engine;
+    WorklistEngine::widening_options_t wideningOptions;
+    bool analyzeAllVariables;
+    std::vector<std::string> variableNames;
+    bool interprocedural;
+    const FunctionSummaries* summaries;
+    std::vector<SeparationTracker::var_pair_t> separationPairs;
+    AnalysisBudget::limits_t budget;
+} analysis_options_t;
+
+typedef struct {
+    std::string functionName;
+    std::vector<std::string> variableNames;
+    IntervalAnalyzer::var_report_t report;
+    unsigned blockVisits;
+    unsigned evaluations;
+    unsigned prunedEdges;
+    std::vector<std::pair<std::string, unsigned>> loopHeadIterations;
+    // Requested pairs found in this function, with their distances
+    std::vector<SeparationTracker::var_pair_t> separationPairs;
+    IntervalAnalyzer::var_report_t separations;
+    SeparationTracker::zone_stats_t zoneStats;
+    double analysisTime;
+    size_t arenaPeakBytes;
+    // The first budget limit the analysis ran past, if any
+    AnalysisBudget::Reason degradation;
+    bool reused;
+    std::chrono::steady_clock::time_point completedAt;
+} function_result_t;
+
+typedef struct {
+    double parseTime;
+    double analysisTime;
+    double reportTime;
+    double firstResultTime;
+    long peakMemoryKilobytes;
+} benchmark_timings_t;
+
+// A module travels through the batch pipeline together with the context that owns it
+typedef struct {
+    unsigned index;
+    std::unique_ptr<LLVMContext> context;
+    std::unique_ptr<Module> module;
+    std::string error;
+} parsed_file_t;
+
+typedef struct {
+    std::string path;
+    std::string error;
+    std::vector<function_result_t> results;
+} file_result_t;
 
-analysis_package_t generateCFG (BasicBlock*, IntervalAnalyzer* intervalAnalyzer, std::stack<BasicBlock*>, AnalyzeLoopBackedgeSwtch, std::string);
+function_result_t analyzeFunction (Function*, const analysis_options_t&);
+std::vector<function_result_t> analyzeFunctionsInParallel (std::vector<Function*>, const analysis_options_t&, unsigned);
+void printFunctionResult (const function_result_t&, AnalysisEngine);
+long getPeakMemoryKilobytes ();
+std::vector<Function*> getAnalyzedFunctions (Module*, bool);
+bool writeProfile (const std::string&);
+void addFunctionReport (ReportWriter*, const std::string&, const function_result_t&);
+bool writeReport (ReportWriter*, const char*);
+uint64_t hashAnalysisOptions (const analysis_options_t&);
+uint64_t hashModule (const Module*);
+std::unique_ptr<FunctionSummaries> buildSummaries (const std::vector<Function*>&, const analysis_options_t&, unsigned, std::string*);
+void warnDegradedSummaries (const FunctionSummaries&, const std::string&);
+function_result_t getReusedResult (const ResultCache::entry_t&);
+std::unique_ptr<Module> loadModule (const std::string&, SMDiagnostic&, LLVMContext&, bool);
+bool materializeFunction (Function*, std::string*);
+bool getBatchFiles (const char*, std::vector<std::string>*);
+unsigned runBatch (const std::vector<std::string>&, const analysis_options_t&, bool, bool, unsigned, ReportWriter*, FILE*);
+bool writeBenchmarkJson (const char*, const char*, AnalysisEngine, bool, unsigned, const std::vector<function_result_t>&, const benchmark_timings_t&);
+analysis_package_t generateCFG (BasicBlock*, IntervalAnalyzer* intervalAnalyzer, std::stack<BasicBlock*>, AnalyzeLoopBackedgeSwtch, ContextTrie::context_id_t, ContextTrie*, const LoopStructure&, Arena*, AnalysisBudget*, unsigned*);
 IntervalAnalyzer* analyzeInterval (BasicBlock*, IntervalAnalyzer* intervalAnalyzer);
-IntervalTracker::var_map_t getLeafNodes(IntervalTracker::var_map_t);
+bool parseEngineOption (const char*, AnalysisEngine*);
+const char* getEngineName (AnalysisEngine);
+bool parseWideningOption (const char*, WorklistEngine::widening_options_t*);
+std::vector<std::string> splitVariableNames (std::string);
+bool parseSeparationPairs (std::string, std::vector<SeparationTracker::var_pair_t>*);
+bool parseBudgetOption (std::string, AnalysisBudget::limits_t*);
+void mergeReports(const context_report_t&, context_report_t*);
+IntervalAnalyzer::var_report_t getLeafNodes(const context_report_t&, const ContextTrie&, unsigned);
 void printIntervalReport(IntervalTracker::var_map_t);
 bool isSameBlock (BasicBlock*, BasicBlock*);
 bool isMainFunction (const char*);
-bool isBeginLoop (const char*);
-bool isEndLoop (const char*);
 void printVars (std::set<Instruction*>);
 void printInsts(std::set<Instruction*>);
 void printLLVMValue (Value* v);
 
 int main (int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <IR file>|%s<file>,...|%s%c<manifest> <variable>[,<variable>...]|%s [%s%s|%s|%s] [%s<n>,...|%s] [%s<passes>] [%s] [%s<workers>] [%s] [%s<file>] [%s%s|%s] [%s<prefix>] [%s<level>] [%s%s|json|binary] [%s<file>] [%s<file>] [%s<file>] [%s%s|%s] [%s<x>%c<y>,...] [%s<limit>%c<n>,...]\n", argv[0], BATCH_OPTION, BATCH_OPTION, BATCH_MANIFEST_PREFIX, ALL_VARIABLES_OPTION, ENGINE_OPTION, ENGINE_WORKLIST, ENGINE_RECURSIVE, ENGINE_SPARSE, THRESHOLDS_OPTION, THRESHOLDS_NONE, NARROWING_OPTION, ALL_FUNCTIONS_OPTION, JOBS_OPTION, SPEEDUP_OPTION, BENCH_JSON_OPTION, LOAD_OPTION, LOAD_LAZY, LOAD_EAGER, PROFILE_OPTION, LOG_OPTION, FORMAT_OPTION, FORMAT_TEXT, OUTPUT_OPTION, INCREMENTAL_OPTION, CACHE_OPTION, INTERPROCEDURAL_OPTION, SWITCH_ON, SWITCH_OFF, SEPARATION_OPTION, PAIR_SEPARATOR, BUDGET_OPTION, PAIR_SEPARATOR);
+        return EXIT_FAILURE;
+    }
+    analysis_options_t options;
+    options.engine = WORKLIST;
+    options.wideningOptions = WorklistEngine::getDefaultOptions();
+    options.analyzeAllVariables = strcmp(argv[2], ALL_VARIABLES_OPTION) == 0;
+    options.variableNames = options.analyzeAllVariables ? std::vector<std::string>() : splitVariableNames(argv[2]);
+    options.interprocedural = true;
+    options.summaries = nullptr;
+    options.budget = AnalysisBudget::getUnlimited();
+    bool analyzeAllFunctions = false;
+    bool measureSpeedup = false;
+    const char* benchmarkJsonPath = nullptr;
+    bool lazyLoading = true;
+    const char* profilePrefix = nullptr;
+    std::unique_ptr<ReportWriter> reportWriter;
+    const char* reportPath = nullptr;
+    const char* incrementalPath = nullptr;
+    const char* cachePath = nullptr;
+    unsigned jobs = 1;
+    for (int arg = 3; arg < argc; ++arg) {
+        if (strcmp(argv[arg], ALL_FUNCTIONS_OPTION) == 0) {
+            analyzeAllFunctions = true;
+        }
+        else if (strcmp(argv[arg], SPEEDUP_OPTION) == 0) {
+            measureSpeedup = true;
+        }
+        else if (strncmp(argv[arg], BENCH_JSON_OPTION, strlen(BENCH_JSON_OPTION)) == 0) {
+            benchmarkJsonPath = argv[arg] + strlen(BENCH_JSON_OPTION);
+        }
+        else if (strncmp(argv[arg], LOG_OPTION, strlen(LOG_OPTION)) == 0) {
+            int level;
+            if (!Log::parseLevel(argv[arg] + strlen(LOG_OPTION), &level)) {
+                LOG(LOG_ERROR, "unknown log level \"%s\"\n", argv[arg] + strlen(LOG_OPTION));
+                return EXIT_FAILURE;
+            }
+            Log::setLevel(level);
+        }
+        else if (strncmp(argv[arg], FORMAT_OPTION, strlen(FORMAT_OPTION)) == 0) {
+            ReportWriter::Format format;
+            if (strcmp(argv[arg] + strlen(FORMAT_OPTION), FORMAT_TEXT) == 0) {
+                reportWriter.reset();
+            }
+            else if (ReportWriter::parseFormat(argv[arg] + strlen(FORMAT_OPTION), &format)) {
+                reportWriter.reset(new ReportWriter(format));
+            }
+            else {
+                LOG(LOG_ERROR, "unknown report format \"%s\"\n", argv[arg] + strlen(FORMAT_OPTION));
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strncmp(argv[arg], OUTPUT_OPTION, strlen(OUTPUT_OPTION)) == 0) {
+            reportPath = argv[arg] + strlen(OUTPUT_OPTION);
+        }
+        else if (strncmp(argv[arg], INCREMENTAL_OPTION, strlen(INCREMENTAL_OPTION)) == 0) {
+            incrementalPath = argv[arg] + strlen(INCREMENTAL_OPTION);
+        }
+        else if (strncmp(argv[arg], CACHE_OPTION, strlen(CACHE_OPTION)) == 0) {
+            cachePath = argv[arg] + strlen(CACHE_OPTION);
+        }
+        else if (strncmp(argv[arg], PROFILE_OPTION, strlen(PROFILE_OPTION)) == 0) {
+            profilePrefix = argv[arg] + strlen(PROFILE_OPTION);
+        }
+        else if ((strcmp(argv[arg], INTERPROCEDURAL_OPTION SWITCH_ON) == 0) ||
+                 (strcmp(argv[arg], INTERPROCEDURAL_OPTION SWITCH_OFF) == 0)) {
+            options.interprocedural = strcmp(argv[arg], INTERPROCEDURAL_OPTION SWITCH_ON) == 0;
+        }
+        else if (strncmp(argv[arg], SEPARATION_OPTION, strlen(SEPARATION_OPTION)) == 0) {
+            if (!parseSeparationPairs(argv[arg] + strlen(SEPARATION_OPTION), &options.separationPairs)) {
+                LOG(LOG_ERROR, "separations are pairs of variables \"x%cy,...\", got \"%s\"\n", PAIR_SEPARATOR, argv[arg] + strlen(SEPARATION_OPTION));
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strncmp(argv[arg], BUDGET_OPTION, strlen(BUDGET_OPTION)) == 0) {
+            if (!parseBudgetOption(argv[arg] + strlen(BUDGET_OPTION), &options.budget)) {
+                LOG(LOG_ERROR, "budgets are limits \"%s|%s|%s|%s%c<n>,...\", got \"%s\"\n", BUDGET_CONTEXTS, BUDGET_VISITS, BUDGET_MEMORY, BUDGET_TIME, PAIR_SEPARATOR, argv[arg] + strlen(BUDGET_OPTION));
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((strcmp(argv[arg], LOAD_OPTION LOAD_LAZY) == 0) ||
+                 (strcmp(argv[arg], LOAD_OPTION LOAD_EAGER) == 0)) {
+            lazyLoading = strcmp(argv[arg], LOAD_OPTION LOAD_LAZY) == 0;
+        }
+        else if (strncmp(argv[arg], JOBS_OPTION, strlen(JOBS_OPTION)) == 0) {
+            if (!StringUtils::parseCount(argv[arg] + strlen(JOBS_OPTION), &jobs)) {
+                LOG(LOG_ERROR, "workers are a count \"%s<workers>\", got \"%s\"\n", JOBS_OPTION, argv[arg] + strlen(JOBS_OPTION));
+                return EXIT_FAILURE;
+            }
+            // The hardware count is 0 when it cannot be determined
+            jobs = (jobs == 0) ? std::max(1u, std::thread::hardware_concurrency()) : jobs;
+        }
+        else if ((strncmp(argv[arg], NARROWING_OPTION, strlen(NARROWING_OPTION)) == 0) ||
+                 (strncmp(argv[arg], THRESHOLDS_OPTION, strlen(THRESHOLDS_OPTION)) == 0)) {
+            if (!parseWideningOption(argv[arg], &options.wideningOptions)) {
+                LOG(LOG_ERROR, "expected \"%s<passes>\" or \"%s<n>,...|%s\", got \"%s\"\n", NARROWING_OPTION, THRESHOLDS_OPTION, THRESHOLDS_NONE, argv[arg]);
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!parseEngineOption(argv[arg], &options.engine)) {
+            LOG(LOG_ERROR, "unknown option \"%s\"\n", argv[arg]);
+            return EXIT_FAILURE;
+        }
+    }
+    // The recursive engine traces every block as it goes, which only reads
+    // sensibly from a single thread
+    if ((options.engine == RECURSIVE) && (jobs > 1)) {
+        LOG(LOG_WARN, "the recursive engine runs on a single thread\n");
+        jobs = 1;
+    }
+    if ((reportPath != nullptr) && !reportWriter) {
+        LOG(LOG_WARN, "%s only applies to the json and binary formats\n", OUTPUT_OPTION);
+    }
+    // Zones live in the block states of the worklist engine, and stored
+    // results carry no separations to reuse
+    if (!options.separationPairs.empty() && (options.engine != WORKLIST)) {
+        LOG(LOG_WARN, "%s only applies to the %s engine\n", SEPARATION_OPTION, ENGINE_WORKLIST);
+        options.separationPairs.clear();
+    }
+    if (!options.separationPairs.empty() && reportWriter) {
+        LOG(LOG_WARN, "%s is only reported in the text format\n", SEPARATION_OPTION);
+    }
+    if (!options.separationPairs.empty() && ((incrementalPath != nullptr) || (cachePath != nullptr))) {
+        LOG(LOG_WARN, "%s and %s are disabled by %s\n", INCREMENTAL_OPTION, CACHE_OPTION, SEPARATION_OPTION);
+        incrementalPath = nullptr;
+        cachePath = nullptr;
+    }
+    // A structured report owns stdout, everything else moves to stderr
+    FILE* statusStream = reportWriter ? stderr : stdout;
+
+    if (strncmp(argv[1], BATCH_OPTION, strlen(BATCH_OPTION)) == 0) {
+        if ((benchmarkJsonPath != nullptr) || measureSpeedup || (incrementalPath != nullptr) || (cachePath != nullptr)) {
+            LOG(LOG_WARN, "%s, %s, %s and %s only apply to a single IR file\n", BENCH_JSON_OPTION, SPEEDUP_OPTION, INCREMENTAL_OPTION, CACHE_OPTION);
+        }
+        std::vector<std::string> files;
+        if (!getBatchFiles(argv[1] + strlen(BATCH_OPTION), &files)) {
+            return EXIT_FAILURE;
+        }
+        unsigned failedFiles = runBatch(files, options, analyzeAllFunctions, lazyLoading, jobs, reportWriter.get(), statusStream);
+        fprintf(statusStream, "Peak memory: %ld KB\n", getPeakMemoryKilobytes());
+        if ((reportWriter && !writeReport(reportWriter.get(), reportPath)) ||
+            ((profilePrefix != nullptr) && !writeProfile(profilePrefix))) {
+            return EXIT_FAILURE;
+        }
+        return (failedFiles == 0) ? 0 : EXIT_FAILURE;
+    }
+
     // Read the IR file.
+    benchmark_timings_t timings;
+    std::chrono::steady_clock::time_point parseStart = std::chrono::steady_clock::now();
     LLVMContext Context;
     SMDiagnostic Err;
-    std::unique_ptr<Module> M = parseIRFile(argv[1], Err, Context);
+    std::unique_ptr<Module> M = loadModule(argv[1], Err, Context, lazyLoading);
+    timings.parseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - parseStart).count();
     if (M == nullptr) {
-        fprintf(stderr, "error: failed to load LLVM IR file \"%s\"", argv[1]);
+        LOG(LOG_ERROR, "failed to load LLVM IR file \"%s\": %s\n", argv[1], Err.getMessage().str().c_str());
         return EXIT_FAILURE;
     }
 
-    IntervalAnalyzer* intervalAnalyzer = new IntervalAnalyzer(argv[2]);
+    std::vector<Function*> functions = getAnalyzedFunctions(M.get(), analyzeAllFunctions);
 
-    for (auto &F: *M) {
-        if (isMainFunction(F.getName().str().c_str())) {
-            BasicBlock* BB = dyn_cast<BasicBlock>(F.begin());
-            std::stack<BasicBlock*> loopCallStack;
+    // Callees are summarized before any caller is analyzed
+    std::unique_ptr<FunctionSummaries> summaries;
+    std::string summaryError;
+    if (options.interprocedural) {
+        std::chrono::steady_clock::time_point summaryStart = std::chrono::steady_clock::now();
+        summaries = buildSummaries(functions, options, jobs, &summaryError);
+        if (!summaries) {
+            LOG(LOG_ERROR, "failed to load LLVM IR file \"%s\": %s\n", argv[1], summaryError.c_str());
+            return EXIT_FAILURE;
+        }
+        options.summaries = summaries.get();
+        if (summaries->getComponentCount() != 0) {
+            std::chrono::duration<double, std::milli> summaryElapsed = std::chrono::steady_clock::now() - summaryStart;
+            fprintf(statusStream, "Summaries: %u call graph components (%u recursive) in %.3f ms\n", summaries->getComponentCount(), summaries->getRecursiveComponentCount(), summaryElapsed.count());
+        }
+    }
+
+    // Hashing follows calls into other bodies, so runs that reuse results read the whole module
+    std::unique_ptr<ResultCache> previousResults;
+    MappedResultCache sharedCache;
+    std::vector<uint64_t> functionHashes;
+    uint64_t moduleHash = 0;
+    uint64_t optionsHash = hashAnalysisOptions(options);
+    if ((incrementalPath != nullptr) || (cachePath != nullptr)) {
+        if (lazyLoading) {
+            if (Error error = M->materializeAll()) {
+                LOG(LOG_ERROR, "failed to load LLVM IR file \"%s\": %s\n", argv[1], toString(std::move(error)).c_str());
+                return EXIT_FAILURE;
+            }
+        }
+        FunctionHasher hasher;
+        for (Function* F : functions) {
+            functionHashes.push_back(hasher.getDependencyHash(F));
+        }
+        moduleHash = hashModule(M.get());
+    }
+    if (incrementalPath != nullptr) {
+        previousResults.reset(new ResultCache(optionsHash));
+        if (!previousResults->load(incrementalPath)) {
+            LOG(LOG_INFO, "no reusable results in \"%s\", analyzing every function\n", incrementalPath);
+        }
+    }
+    if ((cachePath != nullptr) && !sharedCache.open(cachePath)) {
+        LOG(LOG_INFO, "no usable result cache at \"%s\", starting a new one\n", cachePath);
+    }
+
+    // The previous run's results come first, the shared cache second
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<function_result_t> results(functions.size());
+    std::vector<ResultCache::entry_t> entries(functions.size());
+    std::vector<unsigned> pending;
+    unsigned cacheHits = 0;
+    double savedTime = 0;
+    for (unsigned index = 0; index < functions.size(); ++index) {
+        const ResultCache::entry_t* previous = previousResults ? previousResults->lookup(functionHashes[index]) : nullptr;
+        if (previous != nullptr) {
+            entries[index] = *previous;
+        }
+        else if ((cachePath != nullptr) && sharedCache.read({moduleHash, functionHashes[index], optionsHash}, &entries[index])) {
+            ++cacheHits;
+        }
+        else {
+            pending.push_back(index);
+            continue;
+        }
+        results[index] = getReusedResult(entries[index]);
+        savedTime += entries[index].analysisTime;
+    }
+    std::string materializeError;
+    if (jobs == 1) {
+        // Bodies are read one at a time and dropped again once their report is built
+        for (unsigned index : pending) {
+            if (lazyLoading && !materializeFunction(functions[index], &materializeError)) {
+                break;
+            }
+            results[index] = analyzeFunction(functions[index], options);
+            // Summarized bodies stay, callers may still re-analyze them under their arguments
+            if (lazyLoading && !(summaries && summaries->contains(functions[index]))) {
+                functions[index]->deleteBody();
+            }
+        }
+    }
+    else {
+        // Materializing touches the whole module, so it cannot run on the workers
+        std::vector<Function*> pendingFunctions;
+        for (unsigned index : pending) {
+            if (lazyLoading && !materializeFunction(functions[index], &materializeError)) {
+                break;
+            }
+            pendingFunctions.push_back(functions[index]);
+        }
+        if (materializeError.empty()) {
+            std::vector<function_result_t> pendingResults = analyzeFunctionsInParallel(pendingFunctions, options, jobs);
+            for (unsigned index = 0; index < pending.size(); ++index) {
+                results[pending[index]] = pendingResults[index];
+            }
+        }
+    }
+    if (!materializeError.empty()) {
+        LOG(LOG_ERROR, "failed to load LLVM IR file \"%s\": %s\n", argv[1], materializeError.c_str());
+        return EXIT_FAILURE;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    timings.firstResultTime = 0;
+    if (!results.empty()) {
+        std::chrono::steady_clock::time_point firstResult = results.front().completedAt;
+        for (auto& result : results) {
+            firstResult = std::min(firstResult, result.completedAt);
+        }
+        timings.firstResultTime = std::chrono::duration<double, std::milli>(firstResult - parseStart).count();
+    }
+    std::chrono::steady_clock::time_point reportStart = std::chrono::steady_clock::now();
+    for (auto& result : results) {
+        if (reportWriter) {
+            addFunctionReport(reportWriter.get(), argv[1], result);
+        }
+        else {
+            printFunctionResult(result, options.engine);
+        }
+    }
+    if (reportWriter && !writeReport(reportWriter.get(), reportPath)) {
+        return EXIT_FAILURE;
+    }
+    timings.analysisTime = elapsed.count();
+    timings.reportTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reportStart).count();
 
-            analysis_package_t analysisPackage = generateCFG(BB, intervalAnalyzer, loopCallStack, ON, "main");
-            IntervalTracker::var_map_t variableIntervalEndpoints = std::get<0>(analysisPackage);
-            IntervalTracker::var_map_t variableIntervalLeafNodes = getLeafNodes(variableIntervalEndpoints);
-            printf("\nVar: %s Interval Report\n", argv[2]);
-            printf("\n");
-            printIntervalReport(variableIntervalLeafNodes);
+    if (analyzeAllFunctions) {
+        fprintf(statusStream, "Analyzed %zu functions on %u worker(s) in %.3f ms\n", functions.size(), jobs, elapsed.count());
+    }
+    if (summaries && (summaries->getSpecializationCount() != 0)) {
+        fprintf(statusStream, "Call sites specialized: %u\n", summaries->getSpecializationCount());
+    }
+    if (summaries) {
+        warnDegradedSummaries(*summaries, argv[1]);
+    }
+    if ((incrementalPath != nullptr) || (cachePath != nullptr)) {
+        // Reused entries keep the time of the run that computed them, so savings carry over
+        std::vector<MappedResultCache::update_t> updates;
+        for (unsigned index : pending) {
+            entries[index] = {results[index].functionName, results[index].variableNames, results[index].report, results[index].analysisTime};
+            updates.push_back(std::make_pair(MappedResultCache::cache_key_t({moduleHash, functionHashes[index], optionsHash}), &entries[index]));
         }
+        fprintf(statusStream, "Reused: %zu (%u from cache) - Recomputed: %zu - Saved: %.3f ms\n", functions.size() - pending.size(), cacheHits, pending.size(), savedTime);
+        if (previousResults) {
+            ResultCache currentResults(optionsHash);
+            for (unsigned index = 0; index < functions.size(); ++index) {
+                currentResults.store(functionHashes[index], entries[index]);
+            }
+            if (!currentResults.save(incrementalPath)) {
+                LOG(LOG_ERROR, "failed to write results \"%s\"\n", incrementalPath);
+                return EXIT_FAILURE;
+            }
+        }
+        if ((cachePath != nullptr) && !updates.empty() && !MappedResultCache::publish(cachePath, updates)) {
+            LOG(LOG_ERROR, "failed to update result cache \"%s\"\n", cachePath);
+            return EXIT_FAILURE;
+        }
+    }
+    timings.peakMemoryKilobytes = getPeakMemoryKilobytes();
+    fprintf(statusStream, "Load: %s - Load time: %.3f ms - Time to first result: %.3f ms\n", lazyLoading ? LOAD_LAZY : LOAD_EAGER, timings.parseTime, timings.firstResultTime);
+    fprintf(statusStream, "Peak memory: %ld KB\n", timings.peakMemoryKilobytes);
+    if ((benchmarkJsonPath != nullptr) &&
+        !writeBenchmarkJson(benchmarkJsonPath, argv[1], options.engine, lazyLoading, jobs, results, timings)) {
+        LOG(LOG_ERROR, "failed to write benchmark file \"%s\"\n", benchmarkJsonPath);
+        return EXIT_FAILURE;
+    }
+    // Written before the speedup run so that only the reported analysis is profiled
+    if ((profilePrefix != nullptr) && !writeProfile(profilePrefix)) {
+        return EXIT_FAILURE;
+    }
+    if (measureSpeedup && (jobs > 1)) {
+        std::chrono::steady_clock::time_point serialStart = std::chrono::steady_clock::now();
+        for (Function* F : functions) {
+            analyzeFunction(F, options);
+        }
+        std::chrono::duration<double, std::milli> serialElapsed = std::chrono::steady_clock::now() - serialStart;
+        fprintf(statusStream, "Single thread: %.3f ms - %u workers: %.3f ms - Speedup: %.2fx\n", serialElapsed.count(), jobs, elapsed.count(), serialElapsed.count() / elapsed.count());
     }
 
     return 0;
 }
 
+function_result_t analyzeFunction (Function* F, const analysis_options_t& options) {
+    function_result_t result;
+    result.functionName = F->getName().str();
+    result.blockVisits = 0;
+    result.evaluations = 0;
+    result.prunedEdges = 0;
+    result.zoneStats = {};
+    result.reused = false;
+
+    // Every state of this analysis lives in the arena and is released with it
+    Arena arena;
+    AnalysisBudget budget(options.budget);
+    budget.trackArena(&arena);
+    SlotNumbering slots(F);
+    result.variableNames = options.analyzeAllVariables ? IntervalAnalyzer::getNamedVariables(&slots) : options.variableNames;
+    Arena::ptr_t<IntervalAnalyzer> intervalAnalyzer = arena.make<IntervalAnalyzer>(result.variableNames, &slots, &arena);
+    intervalAnalyzer->setCallSummaries(options.summaries);
+    BasicBlock* BB = dyn_cast<BasicBlock>(F->begin());
+    std::stack<BasicBlock*> loopCallStack;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    if (options.engine == RECURSIVE) {
+        LoopStructure loops(F);
+        ContextTrie contexts(result.functionName);
+        analysis_package_t analysisPackage = generateCFG(BB, intervalAnalyzer.get(), loopCallStack, ON, ContextTrie::ROOT, &contexts, loops, &arena, &budget, &result.prunedEdges);
+        if (!budget.isExhausted()) {
+            result.report = getLeafNodes(std::get<0>(analysisPackage), contexts, result.variableNames.size());
+        }
+        else {
+            // The paths explored so far miss the rest, so the exhausted budget
+            // hands the function to the worklist engine in its cheapest mode
+            WorklistEngine worklistEngine(F, *intervalAnalyzer, options.wideningOptions, &arena);
+            worklistEngine.setBudget(&budget);
+            result.report = worklistEngine.run(result.functionName);
+            result.blockVisits = worklistEngine.getBlockVisits();
+            result.prunedEdges = worklistEngine.getPrunedEdges();
+        }
+    }
+    else if (options.engine == WORKLIST) {
+        // Pairs whose variables this function does not declare are left out
+        std::vector<SeparationTracker::slot_pair_t> pairSlots;
+        for (auto& pair : options.separationPairs) {
+            int firstSlot = slots.getSlot(pair.first), secondSlot = slots.getSlot(pair.second);
+            if ((firstSlot != SlotNumbering::NO_SLOT) && (secondSlot != SlotNumbering::NO_SLOT) && (firstSlot != secondSlot) &&
+                isa<AllocaInst>(slots.getValue(firstSlot)) && isa<AllocaInst>(slots.getValue(secondSlot))) {
+                result.separationPairs.push_back(pair);
+                pairSlots.push_back(std::make_pair(firstSlot, secondSlot));
+            }
+        }
+        if (!pairSlots.empty()) {
+            intervalAnalyzer->trackSeparations(SeparationTracker::packVariables(F, &slots, pairSlots), &result.zoneStats);
+        }
+        WorklistEngine worklistEngine(F, *intervalAnalyzer, options.wideningOptions, &arena);
+        worklistEngine.setBudget(&budget);
+        result.report = worklistEngine.run(result.functionName);
+        result.separations = worklistEngine.reportSeparations(result.functionName, pairSlots);
+        result.blockVisits = worklistEngine.getBlockVisits();
+        result.prunedEdges = worklistEngine.getPrunedEdges();
+        for (auto& loopHead : worklistEngine.getLoopHeadIterations()) {
+            result.loopHeadIterations.push_back(std::make_pair(loopHead.first->getName().str(), loopHead.second));
+        }
+    }
+    else {
+        SparseEngine::ssa_function_t ssa = SparseEngine::prepareFunction(F, result.variableNames);
+        SparseEngine sparseEngine(ssa, options.wideningOptions, options.summaries);
+        sparseEngine.setBudget(&budget);
+        result.report = sparseEngine.run(result.functionName);
+        result.evaluations = sparseEngine.getEvaluations();
+        result.prunedEdges = sparseEngine.getPrunedEdges();
+        SparseEngine::releaseFunction(ssa);
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.analysisTime = elapsed.count();
+    result.arenaPeakBytes = arena.getPeakBytesInUse();
+    result.degradation = budget.getReason();
+    result.completedAt = std::chrono::steady_clock::now();
+    return result;
+}
+
+std::vector<function_result_t> analyzeFunctionsInParallel (std::vector<Function*> functions, const analysis_options_t& options, unsigned jobs) {
+    // Every task writes only its own slot, so results come back in module order
+    std::vector<function_result_t> results(functions.size());
+    WorkStealingPool pool(jobs);
+    for (unsigned index = 0; index < functions.size(); ++index) {
+        pool.submit([&functions, &options, &results, index] {
+            results[index] = analyzeFunction(functions[index], options);
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+void printFunctionResult (const function_result_t& result, AnalysisEngine engine) {
+    if (result.reused) {
+        printf("Reused unchanged result for %s\n", result.functionName.c_str());
+    }
+    else if (engine == WORKLIST) {
+        printf("Worklist block visits: %u\n", result.blockVisits);
+        for (auto& loopHead : result.loopHeadIterations) {
+            printf("Loop head %s: %u iterations\n", loopHead.first.c_str(), loopHead.second);
+        }
+    }
+    else if (engine == SPARSE) {
+        printf("Sparse instruction evaluations: %u\n", result.evaluations);
+    }
+    if (!result.reused) {
+        printf("Pruned edges: %u\n", result.prunedEdges);
+    }
+    if (result.degradation != AnalysisBudget::WITHIN_BUDGET) {
+        printf("Degraded: %s budget exceeded, finished %s widening every join\n", AnalysisBudget::getReasonName(result.degradation),
+               (engine == RECURSIVE) ? "on the worklist engine" : "by");
+    }
+    for (unsigned var = 0; var < result.variableNames.size(); ++var) {
+        printf("\nVar: %s Interval Report\n", result.variableNames[var].c_str());
+        printf("\n");
+        printIntervalReport(result.report[var]);
+    }
+    for (unsigned pair = 0; pair < result.separationPairs.size(); ++pair) {
+        const char* first = result.separationPairs[pair].first.c_str();
+        const char* second = result.separationPairs[pair].second.c_str();
+        printf("\nSeparation: %s - %s\n\n", first, second);
+        std::map<std::string, IntervalTracker::interval_t> contexts(result.separations[pair].begin(), result.separations[pair].end());
+        for (auto& context : contexts) {
+            printf("Context: %s - |%s - %s| in [ %s , %s ]\n", context.first.c_str(), first, second,
+                   Interval::formatBound(context.second.lower).c_str(), Interval::formatBound(context.second.upper).c_str());
+        }
+    }
+    if (!result.separationPairs.empty()) {
+        const SeparationTracker::zone_stats_t& stats = result.zoneStats;
+        printf("Zone: %u clusters (largest %u variables) - %u updates - %" PRIu64 " closure cells (%.1f per update, max %" PRIu64 ")\n",
+               stats.clusters, stats.largestCluster, stats.updates, stats.closureCells,
+               (stats.updates == 0) ? 0.0 : (double) stats.closureCells / stats.updates, stats.maxClosureCells);
+    }
+    printf("Engine: %s - Analysis time: %.3f ms - Arena peak: %zu bytes\n", getEngineName(engine), result.analysisTime, result.arenaPeakBytes);
+}
+
+long getPeakMemoryKilobytes () {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    // macOS reports bytes where Linux reports kilobytes
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+std::vector<Function*> getAnalyzedFunctions (Module* M, bool analyzeAllFunctions) {
+    std::vector<Function*> functions;
+    for (auto &F: *M) {
+        if (analyzeAllFunctions ? !F.isDeclaration() : isMainFunction(F.getName().str().c_str())) {
+            functions.push_back(&F);
+        }
+    }
+    return functions;
+}
+
+bool writeProfile (const std::string& prefix) {
+#ifdef INTERVAL_PROFILING
+    std::string summaryPath = prefix + PROFILE_SUMMARY_SUFFIX;
+    std::string tracePath = prefix + PROFILE_TRACE_SUFFIX;
+    if (!Profiler::get().writeSummary(summaryPath.c_str()) ||
+        !Profiler::get().writeTrace(tracePath.c_str())) {
+        LOG(LOG_ERROR, "failed to write profile \"%s\"\n", prefix.c_str());
+        return false;
+    }
+    LOG(LOG_INFO, "Profile: %s - Trace: %s\n", summaryPath.c_str(), tracePath.c_str());
+#else
+    (void) prefix;
+    LOG(LOG_WARN, "%s needs a build with -DINTERVAL_PROFILING\n", PROFILE_OPTION);
+#endif
+    return true;
+}
+
+void addFunctionReport (ReportWriter* reportWriter, const std::string& file, const function_result_t& result) {
+    if (result.degradation != AnalysisBudget::WITHIN_BUDGET) {
+        LOG(LOG_WARN, "%s in \"%s\" degraded: %s budget exceeded\n", result.functionName.c_str(), file.c_str(), AnalysisBudget::getReasonName(result.degradation));
+    }
+    for (unsigned var = 0; var < result.variableNames.size(); ++var) {
+        // Contexts are sorted so the same analysis always writes the same report
+        std::map<std::string, IntervalTracker::interval_t> contexts(result.report[var].begin(), result.report[var].end());
+        for (auto& context : contexts) {
+            reportWriter->addInterval(file, result.functionName, result.variableNames[var], context.first, context.second);
+        }
+    }
+}
+
+uint64_t hashAnalysisOptions (const analysis_options_t& options) {
+    // Everything that changes a report has to change this hash
+    std::ostringstream text;
+    text << options.engine << ' ' << options.analyzeAllVariables << ' ' << options.interprocedural << ' ' << options.wideningOptions.harvestThresholds << ' ' << options.wideningOptions.narrowingPasses;
+    for (int64_t threshold : options.wideningOptions.thresholds) {
+        text << ' ' << threshold;
+    }
+    for (auto& name : options.variableNames) {
+        text << ' ' << name;
+    }
+    for (auto& pair : options.separationPairs) {
+        text << ' ' << pair.first << PAIR_SEPARATOR << pair.second;
+    }
+    text << ' ' << options.budget.maxContexts << ' ' << options.budget.maxVisits << ' ' << options.budget.maxMemoryBytes << ' ' << options.budget.deadlineMilliseconds;
+    return FunctionHasher::hashString(text.str(), FunctionHasher::getSeed());
+}
+
+std::unique_ptr<FunctionSummaries> buildSummaries (const std::vector<Function*>& functions, const analysis_options_t& options, unsigned jobs, std::string* error) {
+    std::unique_ptr<FunctionSummaries> summaries(new FunctionSummaries(options.wideningOptions, options.budget));
+    if (!summaries->collect(functions, error)) {
+        return nullptr;
+    }
+    summaries->build(jobs);
+    return summaries;
+}
+
+void warnDegradedSummaries (const FunctionSummaries& summaries, const std::string& file) {
+    // Summaries and specializations are analyzed on demand, so this goes after every caller
+    for (auto& degradation : summaries.getDegradations()) {
+        LOG(LOG_WARN, "summary of %s in \"%s\" degraded: %s budget exceeded\n", degradation.first->getName().str().c_str(), file.c_str(), AnalysisBudget::getReasonName(degradation.second));
+    }
+}
+
+uint64_t hashModule (const Module* M) {
+    // Modules built from the same source for the same target share their entries
+    uint64_t hash = FunctionHasher::hashString(M->getSourceFileName(), FunctionHasher::getSeed());
+    hash = FunctionHasher::hashString(M->getTargetTriple(), hash);
+    return FunctionHasher::hashString(M->getDataLayoutStr(), hash);
+}
+
+function_result_t getReusedResult (const ResultCache::entry_t& entry) {
+    function_result_t result;
+    result.functionName = entry.functionName;
+    result.variableNames = entry.variableNames;
+    result.report = entry.report;
+    result.blockVisits = 0;
+    result.evaluations = 0;
+    result.prunedEdges = 0;
+    result.zoneStats = {};
+    result.analysisTime = 0;
+    result.arenaPeakBytes = 0;
+    result.degradation = AnalysisBudget::WITHIN_BUDGET;
+    result.reused = true;
+    result.completedAt = std::chrono::steady_clock::now();
+    return result;
+}
+
+bool writeReport (ReportWriter* reportWriter, const char* path) {
+    FILE* file = (path != nullptr) ? fopen(path, "wb") : stdout;
+    bool written = (file != nullptr) && reportWriter->write(file);
+    if ((path != nullptr) && (file != nullptr)) {
+        written = (fclose(file) == 0) && written;
+    }
+    if (!written) {
+        LOG(LOG_ERROR, "failed to write report \"%s\"\n", (path != nullptr) ? path : "<stdout>");
+    }
+    return written;
+}
+
+std::unique_ptr<Module> loadModule (const std::string& path, SMDiagnostic& Err, LLVMContext& Context, bool lazyLoading) {
+    // Bitcode is loaded lazily with every function body left on disk, textual IR is always parsed whole
+    return lazyLoading ? getLazyIRFileModule(path, Err, Context) : parseIRFile(path, Err, Context);
+}
+
+bool materializeFunction (Function* F, std::string* error) {
+    if (Error materializeError = F->materialize()) {
+        *error = toString(std::move(materializeError));
+        return false;
+    }
+    return true;
+}
+
+bool getBatchFiles (const char* batchList, std::vector<std::string>* files) {
+    if (batchList[0] != BATCH_MANIFEST_PREFIX) {
+        *files = splitVariableNames(batchList);
+    }
+    else {
+        // A manifest holds one path per line, blank lines and comments are skipped
+        std::ifstream manifest(batchList + 1);
+        if (!manifest) {
+            LOG(LOG_ERROR, "failed to open manifest \"%s\"\n", batchList + 1);
+            return false;
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            line.erase(0, line.find_first_not_of(" \t"));
+            if (!line.empty() && (line[0] != MANIFEST_COMMENT)) {
+                files->push_back(line);
+            }
+        }
+    }
+    if (files->empty()) {
+        LOG(LOG_WARN, "batch \"%s\" lists no files\n", batchList);
+    }
+    return true;
+}
+
+unsigned runBatch (const std::vector<std::string>& files, const analysis_options_t& options, bool analyzeAllFunctions, bool lazyLoading, unsigned jobs, ReportWriter* reportWriter, FILE* statusStream) {
+    std::vector<file_result_t> fileResults(files.size());
+    // At most one parsed module waits per worker, which bounds the memory held by the pipeline
+    BoundedQueue<parsed_file_t> parsedFiles(jobs);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Workers analyze one module at a time while the main thread parses the next ones
+    std::vector<std::thread> workers;
+    for (unsigned worker = 0; worker < jobs; ++worker) {
+        workers.emplace_back([&parsedFiles, &fileResults, &options, analyzeAllFunctions, lazyLoading] {
+            parsed_file_t parsedFile;
+            while (parsedFiles.pop(&parsedFile)) {
+                file_result_t& fileResult = fileResults[parsedFile.index];
+                fileResult.error = parsedFile.error;
+                if (parsedFile.module != nullptr) {
+                    std::vector<Function*> functions = getAnalyzedFunctions(parsedFile.module.get(), analyzeAllFunctions);
+                    analysis_options_t moduleOptions = options;
+                    std::unique_ptr<FunctionSummaries> summaries;
+                    if (options.interprocedural) {
+                        summaries = buildSummaries(functions, options, 1, &fileResult.error);
+                        moduleOptions.summaries = summaries.get();
+                    }
+                    for (Function* F : functions) {
+                        if ((options.interprocedural && !summaries) ||
+                            (lazyLoading && !materializeFunction(F, &fileResult.error))) {
+                            break;
+                        }
+                        fileResult.results.push_back(analyzeFunction(F, moduleOptions));
+                        if (lazyLoading && !(summaries && summaries->contains(F))) {
+                            F->deleteBody();
+                        }
+                    }
+                    if (summaries) {
+                        warnDegradedSummaries(*summaries, fileResult.path);
+                    }
+                }
+                // The module has to go before the context that owns it
+                parsedFile.module.reset();
+                parsedFile.context.reset();
+            }
+        });
+    }
+    for (unsigned index = 0; index < files.size(); ++index) {
+        parsed_file_t parsedFile;
+        parsedFile.index = index;
+        parsedFile.context.reset(new LLVMContext());
+        SMDiagnostic Err;
+        parsedFile.module = loadModule(files[index], Err, *parsedFile.context, lazyLoading);
+        if (parsedFile.module == nullptr) {
+            parsedFile.error = Err.getMessage().str();
+        }
+        fileResults[index].path = files[index];
+        parsedFiles.push(std::move(parsedFile));
+    }
+    parsedFiles.close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    // Reports come out in input order whichever worker produced them
+    unsigned failedFiles = 0;
+    for (auto& fileResult : fileResults) {
+        if (!reportWriter) {
+            printf("\nFile: %s\n", fileResult.path.c_str());
+        }
+        if (!fileResult.error.empty()) {
+            LOG(LOG_ERROR, "failed to load LLVM IR file \"%s\": %s\n", fileResult.path.c_str(), fileResult.error.c_str());
+            ++failedFiles;
+            continue;
+        }
+        for (auto& result : fileResult.results) {
+            if (reportWriter) {
+                addFunctionReport(reportWriter, fileResult.path, result);
+            }
+            else {
+                printFunctionResult(result, options.engine);
+            }
+        }
+    }
+    fprintf(statusStream, "Batch: %zu files (%u failed) on %u worker(s) in %.3f ms - %.2f files/s\n", files.size(), failedFiles, jobs, elapsed.count(), files.size() / (elapsed.count() / 1000));
+    return failedFiles;
+}
+
+bool writeBenchmarkJson (const char* path, const char* inputPath, AnalysisEngine engine, bool lazyLoading, unsigned jobs, const std::vector<function_result_t>& results, const benchmark_timings_t& timings) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    unsigned blockVisits = 0;
+    unsigned evaluations = 0;
+    unsigned prunedEdges = 0;
+    unsigned degradedFunctions = 0;
+    size_t arenaPeakBytes = 0;
+    for (auto& result : results) {
+        blockVisits += result.blockVisits;
+        evaluations += result.evaluations;
+        prunedEdges += result.prunedEdges;
+        degradedFunctions += (result.degradation != AnalysisBudget::WITHIN_BUDGET) ? 1 : 0;
+        arenaPeakBytes = std::max(arenaPeakBytes, result.arenaPeakBytes);
+    }
+    // Flat object with fixed keys so runs of different versions can be diffed
+    fprintf(file, "{\"input\": \"%s\", \"engine\": \"%s\", \"load\": \"%s\", \"jobs\": %u, \"functions\": %zu, ", StringUtils::escapeJson(inputPath).c_str(), getEngineName(engine), lazyLoading ? LOAD_LAZY : LOAD_EAGER, jobs, results.size());
+    fprintf(file, "\"parse_ms\": %.3f, \"analysis_ms\": %.3f, \"report_ms\": %.3f, \"first_result_ms\": %.3f, ", timings.parseTime, timings.analysisTime, timings.reportTime, timings.firstResultTime);
+    fprintf(file, "\"block_visits\": %u, \"instruction_evaluations\": %u, \"pruned_edges\": %u, \"degraded_functions\": %u, \"arena_peak_bytes\": %zu, \"peak_memory_kb\": %ld, ", blockVisits, evaluations, prunedEdges, degradedFunctions, arenaPeakBytes, timings.peakMemoryKilobytes);
+    fprintf(file, "\"state_kernels\": \"%s\"}\n", StateKernels::get().name);
+    return fclose(file) == 0;
+}
 
 analysis_package_t generateCFG (BasicBlock* BB,
                                 IntervalAnalyzer* intervalAnalyzer,
                                 std::stack<BasicBlock*> loopCallStack,
                                 AnalyzeLoopBackedgeSwtch backedgeSwitch,
-                                std::string parentContextName) {
-  const char *blockName = BB->getName().str().c_str();
-  std::string contextName = parentContextName + DEPTH_SEPARATOR + blockName;
-  printf("Label Name:%s\n", blockName);
+                                ContextTrie::context_id_t parentContext,
+                                ContextTrie* contexts,
+                                const LoopStructure& loops,
+                                Arena* arena,
+                                AnalysisBudget* budget,
+                                unsigned* prunedEdges) {
+  PROFILE_SCOPE("engine", "generateCFG");
+  // Past the budget no further path is explored, the caller falls back to a cheaper engine
+  if (!budget->chargeContext() || !budget->chargeVisit()) {
+      return std::make_tuple(context_report_t(), IntervalAnalyzer(*intervalAnalyzer));
+  }
+  ContextTrie::context_id_t context = contexts->getChild(parentContext, BB);
+  LOG(LOG_DEBUG, "Label Name:%s\n", BB->getName().str().c_str());
 
   // Create local copies of parameters that can be updated
   AnalyzeLoopBackedgeSwtch newBackedgeSwitch = backedgeSwitch;
   std::stack<BasicBlock*> newLoopCallStack = !loopCallStack.empty() ? std::stack<BasicBlock*>(loopCallStack) : std::stack<BasicBlock*>();
-  IntervalAnalyzer* tempIntervalAnalyzer = new IntervalAnalyzer(*intervalAnalyzer);
+  Arena::ptr_t<IntervalAnalyzer> tempIntervalAnalyzer = arena->make<IntervalAnalyzer>(*intervalAnalyzer);
 
   // Track loop layer by pushing them into the stack
-  if (isBeginLoop(blockName)) {
+  if (loops.isLoopBegin(BB)) {
       newLoopCallStack.push(BB);
       tempIntervalAnalyzer->IntervalTracker::switchLoopState(true);
   }
   // Untrack the loop when a loop ends
-  if (isEndLoop(blockName)) {
+  if (loops.isLoopEnd(BB) && !newLoopCallStack.empty()) {
       newLoopCallStack.pop();
       // Turn back on to prepare for any outer loops
       newBackedgeSwitch = ON;
       tempIntervalAnalyzer->IntervalTracker::switchLoopState(false);
   }
 
-  IntervalAnalyzer* newIntervalAnalyzer = analyzeInterval(BB, tempIntervalAnalyzer);
-  IntervalTracker::interval_t interval = newIntervalAnalyzer->getUpdatedInterval();
-  IntervalTracker::var_map_t intervalEndpointTracker({{contextName, interval}});
+  IntervalAnalyzer* newIntervalAnalyzer = analyzeInterval(BB, tempIntervalAnalyzer.get());
+  context_report_t intervalEndpointTracker;
+  intervalEndpointTracker[context] = newIntervalAnalyzer->getIntervals();
 
   // Pass secretVars list to child BBs and check them
-  const TerminatorInst *tInst = BB->getTerminator();
+  const Instruction *tInst = BB->getTerminator();
   int branchCount = tInst->getNumSuccessors();
 
-  // Get the comparator variable to determine which branch to skip
-  std::string branchComparatorName = tInst->getOperand(0)->getName().str();
-  double branchComparatorValue = newIntervalAnalyzer->getVariableValue(branchComparatorName);
+  // Get the comparator variable to determine which branch to skip, a bare
+  // return or unreachable has none
+  int branchComparatorSlot = (tInst->getNumOperands() != 0) ? newIntervalAnalyzer->getSlotNumbering()->getSlot(tInst->getOperand(0)) : SlotNumbering::NO_SLOT;
+  double branchComparatorValue = newIntervalAnalyzer->getVariableValue(branchComparatorSlot);
 
-  printf("\n");
+  LOG(LOG_DEBUG, "\n");
   IntervalAnalyzer propagatedIntervalAnalyzer(*newIntervalAnalyzer);
   for (int i = 0;  i < branchCount; ++i) {
       // Skip branch based on condition
@@ -139,23 +1020,33 @@ analysis_package_t generateCFG (BasicBlock* BB,
       }
 
       BasicBlock *next = tInst->getSuccessor(i);
+
+      // Narrow the comparison operands to the values that take this edge,
+      // and leave the edge unexplored when no value can. Edges into and out
+      // of loops drive the backedge pass below and are always walked
+      Arena::ptr_t<IntervalAnalyzer> subIntervalAnalyzer = arena->make<IntervalAnalyzer>(*newIntervalAnalyzer);
+      const BranchInst* branchInst = dyn_cast<BranchInst>(tInst);
+      if (branchInst && !loops.isLoopBegin(next) && !loops.isLoopEnd(next) &&
+          !subIntervalAnalyzer->refineBranch(branchInst, i)) {
+          ++*prunedEdges;
+          continue;
+      }
       BasicBlock *prevLoopBegin = !newLoopCallStack.empty() ? newLoopCallStack.top() : nullptr;
 
       // If still analyzing loop backedge and the loop is going past the calling point, stop this recursion
-      if (isEndLoop(next->getName().str().c_str()) &&
+      if (loops.isLoopEnd(next) &&
           (newBackedgeSwitch == OFF)) {
           return std::make_tuple(intervalEndpointTracker, propagatedIntervalAnalyzer);
       }
       // Analyze loop backedge by running through the loop one more time before ending
       // to complete taint analysis of variable dependencies
-      if (isEndLoop(next->getName().str().c_str()) &&
+      if (loops.isLoopEnd(next) &&
           (newBackedgeSwitch == ON) &&
           !newLoopCallStack.empty()) {
           // prevent repeating backedge analysis loop
           newBackedgeSwitch = OFF;
-          analysis_package_t analysisPackage = generateCFG(prevLoopBegin, &propagatedIntervalAnalyzer, newLoopCallStack, newBackedgeSwitch, contextName);
-          IntervalTracker::var_map_t intervalEndpoint = std::get<0>(analysisPackage);
-          intervalEndpointTracker.insert(intervalEndpoint.begin(), intervalEndpoint.end());
+          analysis_package_t analysisPackage = generateCFG(prevLoopBegin, &propagatedIntervalAnalyzer, newLoopCallStack, newBackedgeSwitch, context, contexts, loops, arena, budget, prunedEdges);
+          mergeReports(std::get<0>(analysisPackage), &intervalEndpointTracker);
       }
       // Terminate looping condition to acheive least fixed point solution
       if (isSameBlock(prevLoopBegin, next)) {
@@ -163,80 +1054,196 @@ analysis_package_t generateCFG (BasicBlock* BB,
       }
       // Analyze the next instruction and get all the discovered from that analysis context,
       // isolating the consequence of the analyzer in that context from the outer context
-      IntervalAnalyzer* subIntervalAnalyzer = new IntervalAnalyzer(*newIntervalAnalyzer);
-      analysis_package_t analysisPackage = generateCFG(next, subIntervalAnalyzer, newLoopCallStack, newBackedgeSwitch, contextName);
-      IntervalTracker::var_map_t intervalEndpoint = std::get<0>(analysisPackage);
+      analysis_package_t analysisPackage = generateCFG(next, subIntervalAnalyzer.get(), newLoopCallStack, newBackedgeSwitch, context, contexts, loops, arena, budget, prunedEdges);
       propagatedIntervalAnalyzer = IntervalAnalyzer(std::get<1>(analysisPackage));
-      intervalEndpointTracker.insert(intervalEndpoint.begin(), intervalEndpoint.end());
+      mergeReports(std::get<0>(analysisPackage), &intervalEndpointTracker);
   }
 
   return std::make_tuple(intervalEndpointTracker, propagatedIntervalAnalyzer);
 }
 
 IntervalAnalyzer* analyzeInterval (BasicBlock* BB, IntervalAnalyzer* intervalAnalyzer) {
+    PROFILE_SCOPE("engine", "analyzeInterval");
+    PROFILE_BLOCK_VISIT(BB->getParent()->getName().str() + DEPTH_SEPARATOR + BB->getName().str(), intervalAnalyzer->getBoundedIntervalCount());
     // Loop through instructions in BB
-    IntervalAnalyzer::interval_t interval;
     for (auto &I: *BB) {
-        interval = intervalAnalyzer->processNewInstruction(&I);
-        intervalAnalyzer->printIntervalReport();
+        intervalAnalyzer->processNewInstruction(&I);
+        if (LOG_ENABLED(LOG_TRACE)) {
+            intervalAnalyzer->printIntervalReport();
+        }
     }
     return intervalAnalyzer;
 }
 
-IntervalTracker::var_map_t getLeafNodes(IntervalTracker::var_map_t intervals) {
-    int maxDepth = 0;
-    for (auto& it :  intervals) {
-        std::string contextName = it.first;
-        size_t n = std::count(contextName.begin(), contextName.end(), DEPTH_SEPARATOR);
-        int depth = static_cast<int>(n);
-        maxDepth = (maxDepth < depth) ? depth : maxDepth;
+bool parseEngineOption (const char* option, AnalysisEngine* engine) {
+    if (strncmp(option, ENGINE_OPTION, strlen(ENGINE_OPTION)) != 0) {
+        return false;
+    }
+    const char* engineName = option + strlen(ENGINE_OPTION);
+    if (strcmp(engineName, ENGINE_RECURSIVE) == 0) {
+        *engine = RECURSIVE;
+        return true;
+    }
+    if (strcmp(engineName, ENGINE_WORKLIST) == 0) {
+        *engine = WORKLIST;
+        return true;
     }
+    if (strcmp(engineName, ENGINE_SPARSE) == 0) {
+        *engine = SPARSE;
+        return true;
+    }
+    return false;
+}
 
-    IntervalTracker::var_map_t leafNodes;
-    for (auto& it :  intervals) {
-        std::string contextName = it.first;
-        size_t n = std::count(contextName.begin(), contextName.end(), DEPTH_SEPARATOR);
-        int depth = static_cast<int>(n);
+const char* getEngineName (AnalysisEngine engine) {
+    switch (engine) {
+        case RECURSIVE:
+            return ENGINE_RECURSIVE;
+        case SPARSE:
+            return ENGINE_SPARSE;
+        default:
+            return ENGINE_WORKLIST;
+    }
+}
+
+std::vector<std::string> splitVariableNames (std::string variableList) {
+    std::vector<std::string> names;
+    std::stringstream listStream(variableList);
+    std::string name;
+    while (std::getline(listStream, name, VARIABLE_SEPARATOR)) {
+        if (!name.empty()) {
+            names.push_back(name);
+        }
+    }
+    return names;
+}
+
+bool parseSeparationPairs (std::string pairList, std::vector<SeparationTracker::var_pair_t>* pairs) {
+    for (auto& pair : splitVariableNames(pairList)) {
+        size_t separator = pair.find(PAIR_SEPARATOR);
+        if ((separator == std::string::npos) || (separator == 0) || (separator + 1 == pair.size())) {
+            return false;
+        }
+        pairs->push_back(std::make_pair(pair.substr(0, separator), pair.substr(separator + 1)));
+    }
+    return !pairs->empty();
+}
+
+bool parseBudgetOption (std::string limitList, AnalysisBudget::limits_t* limits) {
+    for (auto& limit : splitVariableNames(limitList)) {
+        size_t separator = limit.find(PAIR_SEPARATOR);
+        if (separator == std::string::npos) {
+            return false;
+        }
+        std::string name = limit.substr(0, separator);
+        const char* value = limit.c_str() + separator + 1;
+        double amount = 0;
+        if (name == BUDGET_CONTEXTS) {
+            if (!StringUtils::parseCount(value, &limits->maxContexts)) {
+                return false;
+            }
+        }
+        else if (name == BUDGET_VISITS) {
+            if (!StringUtils::parseCount(value, &limits->maxVisits)) {
+                return false;
+            }
+        }
+        else if (name == BUDGET_MEMORY) {
+            // Given in megabytes
+            if (!StringUtils::parseDecimal(value, &amount) || (amount * BYTES_PER_MEGABYTE >= (double) SIZE_MAX)) {
+                return false;
+            }
+            limits->maxMemoryBytes = static_cast<size_t>(amount * BYTES_PER_MEGABYTE);
+        }
+        else if (name == BUDGET_TIME) {
+            // Given in milliseconds
+            if (!StringUtils::parseDecimal(value, &limits->deadlineMilliseconds)) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void mergeReports(const context_report_t& source, context_report_t* destination) {
+    destination->insert(source.begin(), source.end());
+}
+
+bool parseWideningOption (const char* option, WorklistEngine::widening_options_t* options) {
+    if (strncmp(option, NARROWING_OPTION, strlen(NARROWING_OPTION)) == 0) {
+        return StringUtils::parseCount(option + strlen(NARROWING_OPTION), &options->narrowingPasses);
+    }
+    if (strncmp(option, THRESHOLDS_OPTION, strlen(THRESHOLDS_OPTION)) != 0) {
+        return false;
+    }
+    // An explicit list replaces the thresholds harvested from the comparisons
+    const char* thresholdList = option + strlen(THRESHOLDS_OPTION);
+    options->harvestThresholds = false;
+    options->thresholds.clear();
+    if (strcmp(thresholdList, THRESHOLDS_NONE) == 0) {
+        return true;
+    }
+    for (auto& threshold : splitVariableNames(thresholdList)) {
+        char* end = nullptr;
+        errno = 0;
+        long long value = strtoll(threshold.c_str(), &end, 10);
+        if (threshold.empty() || (*end != '\0') || (errno == ERANGE)) {
+            return false;
+        }
+        options->thresholds.push_back(value);
+    }
+    return true;
+}
+
+IntervalAnalyzer::var_report_t getLeafNodes(const context_report_t& intervals, const ContextTrie& contexts, unsigned variableCount) {
+    // Keep the deepest contexts in one pass, a deeper one drops those found so far
+    unsigned maxDepth = 0;
+    std::vector<const context_report_t::value_type*> leafNodes;
+    for (auto& it : intervals) {
+        unsigned depth = contexts.getDepth(it.first);
+        if (depth > maxDepth) {
+            maxDepth = depth;
+            leafNodes.clear();
+        }
         if (depth == maxDepth) {
-            leafNodes.insert(it);
+            leafNodes.push_back(&it);
+        }
+    }
+
+    // Context names are only built for the contexts that are reported
+    IntervalAnalyzer::var_report_t report(variableCount);
+    for (auto leafNode : leafNodes) {
+        std::string contextName = contexts.getName(leafNode->first);
+        for (unsigned var = 0; var < variableCount; ++var) {
+            report[var][contextName] = leafNode->second[var];
         }
     }
-    return leafNodes;
+    return report;
 }
 
 void printIntervalReport(IntervalTracker::var_map_t intervals) {
     printf("\n");
     for (auto& it :  intervals) {
         std::string contextName = it.first;
-        double min = std::get<0>(it.second);
-        double max = std::get<1>(it.second);
-        std::string minString = (std::isnan(min)) ? "-infinity" : std::to_string(min);
-        std::string maxString = (std::isnan(max)) ? "+infinity" : std::to_string(max);
+        std::string minString = Interval::formatBound(it.second.lower);
+        std::string maxString = Interval::formatBound(it.second.upper);
         printf("Context: %s - [ %s , %s ]\n", contextName.c_str(), minString.c_str(), maxString.c_str());
     }
     printf("\n");
 }
 
 bool isSameBlock (BasicBlock* blockA, BasicBlock* blockB) {
-    // Prevent nullptr reference
-    if (!blockA || !blockB) {
-        return false;
-    }
-    return blockA->getName().str() == blockB->getName().str();
+    // Blocks are unique within a function, unnamed ones included
+    return (blockA != nullptr) && (blockA == blockB);
 }
 
 bool isMainFunction (const char* functionName) {
     return strncmp(functionName, MAIN_FUNCTION, strlen(MAIN_FUNCTION)) == 0;
 }
 
-bool isBeginLoop (const char* instructionName) {
-    return strncmp(instructionName, LOOP_BEGIN_BLOCK_NAME, strlen(LOOP_BEGIN_BLOCK_NAME)) == 0;
-}
-
-bool isEndLoop (const char* instructionName) {
-    return strncmp(instructionName, LOOP_END_BLOCK_NAME, strlen(LOOP_END_BLOCK_NAME)) == 0;
-}
-
 void printVars (std::set<Instruction*> vars) {
     for (auto &S: vars) {
         printf("%s ", S->getName().str().c_str() );